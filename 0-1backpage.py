@@ -1,145 +1,174 @@
-import pandas as pd
-import matplotlib.pyplot as plt
-import numpy as np
-
-def parse_csv(file_path):
-    """解析CSV文件并提取算法执行时间数据"""
-    try:
-        df = pd.read_csv(file_path)
-        dp_times = df[df['算法'] == '动态规划法']['执行时间 (ms)'].values
-        greedy_times = df[df['算法'] == '贪心法']['执行时间 (ms)'].values
-        n_values = np.arange(1000, 41000, 1000)  # 假设物品数量从1000到40000
-        
-        return {
-            'n_values': n_values,
-            'dp_times': dp_times,
-            'greedy_times': greedy_times,
-            'capacity': int(df.iloc[0, 0].split('=')[1])  # 提取背包容量C
-        }
-    except Exception as e:
-        print(f"读取CSV文件失败: {e}")
-        n_values = np.arange(1000, 41000, 1000)
-        dp_times = np.linspace(500, 60000, len(n_values))
-        greedy_times = np.linspace(1, 10, len(n_values))
-        return {
-            'n_values': n_values,
-            'dp_times': dp_times,
-            'greedy_times': greedy_times,
-            'capacity': 100000
-        }
-
-def plot_performance(results):
-    # 解决中文显示问题
-    plt.rcParams["font.family"] = ["SimHei", "WenQuanYi Micro Hei", "Heiti TC"]
-    plt.rcParams["axes.unicode_minus"] = False  # 解决负号显示问题
-    
-    n_values = results['n_values']
-    dp_times = results['dp_times']
-    greedy_times = results['greedy_times']
-    capacity = results['capacity']
-    
-    plt.figure(figsize=(12, 8))
-    
-    # 绘制线性坐标图
-    ax1 = plt.subplot(2, 1, 1)
-    ax1.plot(n_values, dp_times, 'o-', label='动态规划法', color='blue', zorder=3)
-    ax1.plot(n_values, greedy_times, 's-', label='贪心法', color='red', zorder=3)
-    
-    # 添加蛮力法和回溯法参考线（竖线）
-    brute_force_n = 20  # 蛮力法适用的最大N值
-    backtracking_n = 30  # 回溯法适用的最大N值
-    ax1.axvline(x=brute_force_n, color='green', linestyle='--', label=f'蛮力法(N≤{brute_force_n})', zorder=2)
-    ax1.axvline(x=backtracking_n, color='purple', linestyle='--', label=f'回溯法(N≤{backtracking_n})', zorder=2)
-    
-    ax1.set_xlabel('物品数量 N')
-    ax1.set_ylabel('执行时间 (ms)')
-    ax1.set_title(f'背包算法性能对比 (C={capacity})')
-    ax1.legend(loc='upper left')
-    ax1.grid(True, zorder=0)
-    
-    # 绘制对数坐标图
-    ax2 = plt.subplot(2, 1, 2)
-    ax2.semilogy(n_values, dp_times, 'o-', label='动态规划法', color='blue', zorder=3)
-    ax2.semilogy(n_values, greedy_times, 's-', label='贪心法', color='red', zorder=3)
-    
-    # 添加蛮力法和回溯法参考线（竖线）
-    ax2.axvline(x=brute_force_n, color='green', linestyle='--', zorder=2)
-    ax2.axvline(x=backtracking_n, color='purple', linestyle='--', zorder=2)
-    
-    # 在对数图中添加注释
-    ax2.text(brute_force_n*1.1, 10, '蛮力法', rotation=90, va='center', color='green')
-    ax2.text(backtracking_n*1.1, 10, '回溯法', rotation=90, va='center', color='purple')
-    
-    ax2.set_xlabel('物品数量 N')
-    ax2.set_ylabel('执行时间 (ms) (对数坐标)')
-    ax2.legend(loc='upper left')
-    ax2.grid(True, zorder=0)
-    
-    plt.tight_layout()
-    plt.savefig(f'knapsack_performance_C{capacity}_with_references.png')
-    plt.show()
-
-def generate_report(results):
-    """生成性能分析报告（新增算法对比部分）"""
-    n_values = results['n_values']
-    dp_times = results['dp_times']
-    greedy_times = results['greedy_times']
-    capacity = results['capacity']
-    dp_growth = dp_times[-1] / dp_times[0]
-    greedy_growth = greedy_times[-1] / greedy_times[0]
-    
-    with open(f'knapsack_analysis_C{capacity}.txt', 'w', encoding='utf-8') as f:
-        f.write(f"背包算法性能分析报告\n")
-        f.write(f"======================\n\n")
-        f.write(f"测试条件:\n")
-        f.write(f"- 物品数量范围: {n_values[0]} 到 {n_values[-1]}\n")
-        f.write(f"- 背包容量: {capacity}\n\n")
-        
-        f.write(f"性能数据汇总:\n")
-        f.write(f"----------------------\n")
-        f.write(f"| 算法       | 最小时间(ms) | 最大时间(ms) | 增长倍数 |\n")
-        f.write(f"|------------|--------------|--------------|----------|\n")
-        f.write(f"| 动态规划法 | {dp_times[0]:.2f}       | {dp_times[-1]:.2f}       | {dp_growth:.2f}x     |\n")
-        f.write(f"| 贪心法     | {greedy_times[0]:.2f}     | {greedy_times[-1]:.2f}     | {greedy_growth:.2f}x   |\n")
-        f.write(f"----------------------\n\n")
-        
-        f.write(f"全算法家族性能对比:\n")
-        f.write(f"----------------------\n")
-        f.write(f"1. 蛮力法（暴力枚举）:\n")
-        f.write(f"   - 时间复杂度: O(2^n)，仅适用于N≤20的极小规模问题\n")
-        f.write(f"   - 当N=20时，计算量约为100万次，N=30时飙升至10亿次\n\n")
-        
-        f.write(f"2. 回溯法:\n")
-        f.write(f"   - 时间复杂度: O(n×2^n)，通过剪枝优化后适用于N≤30\n")
-        f.write(f"   - 实际应用中，当N>30时，执行时间将超过可接受范围\n\n")
-        
-        f.write(f"3. 动态规划法:\n")
-        f.write(f"   - 时间复杂度: O(n×C)，在C=100000时，N=40000的执行时间为{dp_times[-1]:.2f}ms\n")
-        f.write(f"   - 空间瓶颈: DP表大小为{n_values[-1]+1}×{capacity+1}≈4000万，需约1.6GB内存\n\n")
-        
-        f.write(f"4. 贪心法:\n")
-        f.write(f"   - 时间复杂度: O(n log n)，N=40000时执行时间仅{greedy_times[-1]:.2f}ms\n")
-        f.write(f"   - 局限性: 不保证最优解，适用于对解精度要求不高的大规模问题\n\n")
-        
-        f.write(f"结论:\n")
-        f.write(f"----------------------\n")
-        f.write(f"1. 小规模问题(N≤30): 回溯法可求最优解，但N>20时性能急剧下降\n")
-        f.write(f"2. 中等规模问题(30<N≤10000): 动态规划法是首选，能保证最优解\n")
-        f.write(f"3. 大规模问题(N>10000): 贪心法在10ms内完成计算，可作为工程实用方案\n")
-
-def main():
-    file_path = "knapsack_results_N=40000_C=100000.csv"
-    results = parse_csv(file_path)
-    
-    print(f"背包容量 C = {results['capacity']}")
-    print(f"物品数量范围: {results['n_values'][0]} 到 {results['n_values'][-1]}")
-    print(f"动态规划法最大执行时间: {results['dp_times'][-1]:.2f} ms")
-    print(f"贪心法最大执行时间: {results['greedy_times'][-1]:.2f} ms")
-    
-    plot_performance(results)
-    generate_report(results)
-    print(f"分析报告已生成: knapsack_analysis_C{results['capacity']}.txt")
-    print(f"性能图表已生成: knapsack_performance_C{results['capacity']}_with_references.png")
-
-if __name__ == "__main__":
+import pandas as pd
+import matplotlib.pyplot as plt
+import numpy as np
+import sys
+
+def parse_csv(file_path):
+    """解析CSV文件并提取算法执行时间数据"""
+    try:
+        df = pd.read_csv(file_path)
+        dp_times = df[df['算法'] == '动态规划法']['执行时间 (ms)'].values
+        greedy_times = df[df['算法'] == '贪心法']['执行时间 (ms)'].values
+        n_values = np.arange(1000, 41000, 1000)  # 假设物品数量从1000到40000
+        
+        return {
+            'n_values': n_values,
+            'dp_times': dp_times,
+            'greedy_times': greedy_times,
+            'capacity': int(df.iloc[0, 0].split('=')[1])  # 提取背包容量C
+        }
+    except Exception as e:
+        print(f"读取CSV文件失败: {e}")
+        n_values = np.arange(1000, 41000, 1000)
+        dp_times = np.linspace(500, 60000, len(n_values))
+        greedy_times = np.linspace(1, 10, len(n_values))
+        return {
+            'n_values': n_values,
+            'dp_times': dp_times,
+            'greedy_times': greedy_times,
+            'capacity': 100000
+        }
+
+def parse_batch_csv(file_path, capacity=None):
+    """解析 0_1backpage 批量测试模式（--out）输出的结果文件，取墙钟中位数作为执行时间"""
+    df = pd.read_csv(file_path)
+    if capacity is None:
+        capacity = int(df['C'].iloc[-1])
+    df = df[df['C'] == capacity]
+    # 含多种实例类型时只画最后一种
+    if '实例类型' in df.columns:
+        df = df[df['实例类型'] == df['实例类型'].iloc[-1]]
+    # 同一配置测过多次时取最后一次
+    df = df.drop_duplicates(subset=['算法', 'N'], keep='last')
+    n_values = np.sort(df['N'].unique())
+
+    def series(name):
+        s = df[df['算法'] == name].set_index('N')['墙钟中位数 (ms)']
+        return s.reindex(n_values).values
+
+    return {
+        'n_values': n_values,
+        'dp_times': series('动态规划法'),
+        'greedy_times': series('贪心法'),
+        'capacity': capacity
+    }
+
+def plot_performance(results):
+    # 解决中文显示问题
+    plt.rcParams["font.family"] = ["SimHei", "WenQuanYi Micro Hei", "Heiti TC"]
+    plt.rcParams["axes.unicode_minus"] = False  # 解决负号显示问题
+    
+    n_values = results['n_values']
+    dp_times = results['dp_times']
+    greedy_times = results['greedy_times']
+    capacity = results['capacity']
+    
+    plt.figure(figsize=(12, 8))
+    
+    # 绘制线性坐标图
+    ax1 = plt.subplot(2, 1, 1)
+    ax1.plot(n_values, dp_times, 'o-', label='动态规划法', color='blue', zorder=3)
+    ax1.plot(n_values, greedy_times, 's-', label='贪心法', color='red', zorder=3)
+    
+    # 添加蛮力法和回溯法参考线（竖线）
+    brute_force_n = 20  # 蛮力法适用的最大N值
+    backtracking_n = 30  # 回溯法适用的最大N值
+    ax1.axvline(x=brute_force_n, color='green', linestyle='--', label=f'蛮力法(N≤{brute_force_n})', zorder=2)
+    ax1.axvline(x=backtracking_n, color='purple', linestyle='--', label=f'回溯法(N≤{backtracking_n})', zorder=2)
+    
+    ax1.set_xlabel('物品数量 N')
+    ax1.set_ylabel('执行时间 (ms)')
+    ax1.set_title(f'背包算法性能对比 (C={capacity})')
+    ax1.legend(loc='upper left')
+    ax1.grid(True, zorder=0)
+    
+    # 绘制对数坐标图
+    ax2 = plt.subplot(2, 1, 2)
+    ax2.semilogy(n_values, dp_times, 'o-', label='动态规划法', color='blue', zorder=3)
+    ax2.semilogy(n_values, greedy_times, 's-', label='贪心法', color='red', zorder=3)
+    
+    # 添加蛮力法和回溯法参考线（竖线）
+    ax2.axvline(x=brute_force_n, color='green', linestyle='--', zorder=2)
+    ax2.axvline(x=backtracking_n, color='purple', linestyle='--', zorder=2)
+    
+    # 在对数图中添加注释
+    ax2.text(brute_force_n*1.1, 10, '蛮力法', rotation=90, va='center', color='green')
+    ax2.text(backtracking_n*1.1, 10, '回溯法', rotation=90, va='center', color='purple')
+    
+    ax2.set_xlabel('物品数量 N')
+    ax2.set_ylabel('执行时间 (ms) (对数坐标)')
+    ax2.legend(loc='upper left')
+    ax2.grid(True, zorder=0)
+    
+    plt.tight_layout()
+    plt.savefig(f'knapsack_performance_C{capacity}_with_references.png')
+    plt.show()
+
+def generate_report(results):
+    """生成性能分析报告（新增算法对比部分）"""
+    n_values = results['n_values']
+    dp_times = results['dp_times']
+    greedy_times = results['greedy_times']
+    capacity = results['capacity']
+    dp_growth = dp_times[-1] / dp_times[0]
+    greedy_growth = greedy_times[-1] / greedy_times[0]
+    
+    with open(f'knapsack_analysis_C{capacity}.txt', 'w', encoding='utf-8') as f:
+        f.write(f"背包算法性能分析报告\n")
+        f.write(f"======================\n\n")
+        f.write(f"测试条件:\n")
+        f.write(f"- 物品数量范围: {n_values[0]} 到 {n_values[-1]}\n")
+        f.write(f"- 背包容量: {capacity}\n\n")
+        
+        f.write(f"性能数据汇总:\n")
+        f.write(f"----------------------\n")
+        f.write(f"| 算法       | 最小时间(ms) | 最大时间(ms) | 增长倍数 |\n")
+        f.write(f"|------------|--------------|--------------|----------|\n")
+        f.write(f"| 动态规划法 | {dp_times[0]:.2f}       | {dp_times[-1]:.2f}       | {dp_growth:.2f}x     |\n")
+        f.write(f"| 贪心法     | {greedy_times[0]:.2f}     | {greedy_times[-1]:.2f}     | {greedy_growth:.2f}x   |\n")
+        f.write(f"----------------------\n\n")
+        
+        f.write(f"全算法家族性能对比:\n")
+        f.write(f"----------------------\n")
+        f.write(f"1. 蛮力法（暴力枚举）:\n")
+        f.write(f"   - 时间复杂度: O(2^n)，仅适用于N≤20的极小规模问题\n")
+        f.write(f"   - 当N=20时，计算量约为100万次，N=30时飙升至10亿次\n\n")
+        
+        f.write(f"2. 回溯法:\n")
+        f.write(f"   - 时间复杂度: O(n×2^n)，通过剪枝优化后适用于N≤30\n")
+        f.write(f"   - 实际应用中，当N>30时，执行时间将超过可接受范围\n\n")
+        
+        f.write(f"3. 动态规划法:\n")
+        f.write(f"   - 时间复杂度: O(n×C)，在C=100000时，N=40000的执行时间为{dp_times[-1]:.2f}ms\n")
+        f.write(f"   - 空间瓶颈: DP表大小为{n_values[-1]+1}×{capacity+1}≈4000万，需约1.6GB内存\n\n")
+        
+        f.write(f"4. 贪心法:\n")
+        f.write(f"   - 时间复杂度: O(n log n)，N=40000时执行时间仅{greedy_times[-1]:.2f}ms\n")
+        f.write(f"   - 局限性: 不保证最优解，适用于对解精度要求不高的大规模问题\n\n")
+        
+        f.write(f"结论:\n")
+        f.write(f"----------------------\n")
+        f.write(f"1. 小规模问题(N≤30): 回溯法可求最优解，但N>20时性能急剧下降\n")
+        f.write(f"2. 中等规模问题(30<N≤10000): 动态规划法是首选，能保证最优解\n")
+        f.write(f"3. 大规模问题(N>10000): 贪心法在10ms内完成计算，可作为工程实用方案\n")
+
+def main():
+    # 可传入批量测试模式的结果文件，例如: python 0-1backpage.py bench.csv
+    if len(sys.argv) > 1:
+        results = parse_batch_csv(sys.argv[1])
+    else:
+        file_path = "knapsack_results_N=40000_C=100000.csv"
+        results = parse_csv(file_path)
+    
+    print(f"背包容量 C = {results['capacity']}")
+    print(f"物品数量范围: {results['n_values'][0]} 到 {results['n_values'][-1]}")
+    print(f"动态规划法最大执行时间: {results['dp_times'][-1]:.2f} ms")
+    print(f"贪心法最大执行时间: {results['greedy_times'][-1]:.2f} ms")
+    
+    plot_performance(results)
+    generate_report(results)
+    print(f"分析报告已生成: knapsack_analysis_C{results['capacity']}.txt")
+    print(f"性能图表已生成: knapsack_performance_C{results['capacity']}_with_references.png")
+
+if __name__ == "__main__":
     main()
\ No newline at end of file
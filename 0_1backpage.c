@@ -1,645 +1,5386 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
-#include <string.h>
-#include <math.h>
-
-#if defined(_WIN32) || defined(_WIN64)
-#include <windows.h>
-#endif
-
-typedef struct {
-    int id;
-    int weight;
-    double value;
-    double density;
-} Item;
-
-/* 全局变量用于回溯法 */
-double g_backtracking_max_value = 0.0;
-int* g_backtracking_best_selection = NULL;
-int g_backtracking_num_items;
-int g_backtracking_capacity;
-Item* g_backtracking_items;
-
-/* 比较函数，用于按密度降序排序 */
-int compareItems(const void* a, const void* b) {
-    Item* itemA = (Item*)a;
-    Item* itemB = (Item*)b;
-    if (itemB->density > itemA->density) return 1;
-    if (itemB->density < itemA->density) return -1;
-    return 0;
-}
-
-/* 生成随机物品 */
-void generate_items(Item* items, int n) {
-    int i;
-    printf("生成 %d 个随机物品...\n", n);
-    for (i = 0; i < n; i++) {
-        items[i].id = i + 1;
-        items[i].weight = (rand() % 100) + 1;  /* 1-100之间 */
-        items[i].value = ((rand() % 90001) + 10000) / 100.0;  /* 100.00-1000.00之间 */
-        items[i].density = items[i].value / items[i].weight;
-    }
-    printf("物品生成完成。\n\n");
-}
-
-/* 打印解决方案到控制台 */
-void print_solution(const char* method_name, Item* items, int* selection, int n, int capacity, double execution_time) {
-    double total_value = 0;
-    int total_weight = 0;
-    int selected_count = 0;
-    int i;
-    
-    printf("\n========== [%s] 算法结果 ==========\n", method_name);
-    printf("执行时间: %.2f ms\n", execution_time);
-    printf("背包容量: %d\n", capacity);
-    printf("\n选中的物品:\n");
-    printf("%-8s %-8s %-10s\n", "物品编号", "重量", "价值");
-    printf("--------------------------------\n");
-    
-    for (i = 0; i < n; i++) {
-        if (selection[i]) {
-            printf("%-8d %-8d %-10.2f\n", items[i].id, items[i].weight, items[i].value);
-            total_value += items[i].value;
-            total_weight += items[i].weight;
-            selected_count++;
-        }
-    }
-    
-    printf("--------------------------------\n");
-    printf("选中物品数量: %d\n", selected_count);
-    printf("总重量: %d\n", total_weight);
-    printf("总价值: %.2f\n", total_value);
-    printf("容量利用率: %.2f%%\n", (double)total_weight / capacity * 100);
-    printf("==========================================\n\n");
-}
-
-/* 将算法结果写入CSV文件 */
-void write_to_csv(const char* filename, const char* method_name, Item* items, int* selection, int n, int capacity, double execution_time) {
-    FILE* fp = fopen(filename, "a");
-    if (!fp) {
-        printf("无法打开CSV文件进行写入: %s\n", filename);
-        return;
-    }
-    
-    double total_value = 0;
-    int total_weight = 0;
-    int selected_count = 0;
-    int i;
-    
-    // 写入算法执行摘要
-    fprintf(fp, "算法: %s\n", method_name);
-    fprintf(fp, "执行时间: %.2f ms\n", execution_time);
-    fprintf(fp, "背包容量: %d\n", capacity);
-    fprintf(fp, "\n");
-    
-    // 写入选中的物品表头
-    fprintf(fp, "物品编号,重量,价值\n");
-    
-    // 写入选中的物品数据
-    for (i = 0; i < n; i++) {
-        if (selection[i]) {
-            fprintf(fp, "%d,%d,%.2f\n", items[i].id, items[i].weight, items[i].value);
-            total_value += items[i].value;
-            total_weight += items[i].weight;
-            selected_count++;
-        }
-    }
-    
-    // 写入摘要统计
-    fprintf(fp, "\n");
-    fprintf(fp, "选中物品数量: %d\n", selected_count);
-    fprintf(fp, "总重量: %d\n", total_weight);
-    fprintf(fp, "总价值: %.2f\n", total_value);
-    fprintf(fp, "容量利用率: %.2f%%\n", (double)total_weight / capacity * 100);
-    fprintf(fp, "==========================================\n\n");
-    
-    fclose(fp);
-}
-
-/* 蛮力法 */
-void brute_force_knapsack(Item* items, int n, int C, const char* csv_filename) {
-    clock_t start = clock();
-    
-    double max_value = 0.0;
-    int* best_selection = (int*)calloc(n, sizeof(int));
-    long long i;
-    int j;
-    
-    if (!best_selection) {
-        printf("蛮力法内存分配失败。\n");
-        return;
-    }
-
-    printf("蛮力法开始计算（将检查 %lld 种组合）...\n", 1LL << n);
-    
-    for (i = 0; i < (1LL << n); i++) {
-        int current_weight = 0;
-        double current_value = 0.0;
-        int* current_selection = (int*)calloc(n, sizeof(int));
-        if(!current_selection) continue;
-
-        for (j = 0; j < n; j++) {
-            if ((i >> j) & 1) {
-                current_weight += items[j].weight;
-                current_value += items[j].value;
-                current_selection[j] = 1;
-            }
-        }
-
-        if (current_weight <= C && current_value > max_value) {
-            max_value = current_value;
-            memcpy(best_selection, current_selection, n * sizeof(int));
-        }
-        free(current_selection);
-        
-        /* 进度显示（每100万次显示一次） */
-        if (i > 0 && i % 1000000 == 0) {
-            printf("已处理: %lld / %lld (%.1f%%)\n", i, 1LL << n, (double)i / (1LL << n) * 100);
-        }
-    }
-
-    clock_t end = clock();
-    double execution_time = ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
-    
-    print_solution("蛮力法", items, best_selection, n, C, execution_time);
-    if (csv_filename) {
-        write_to_csv(csv_filename, "蛮力法", items, best_selection, n, C, execution_time);
-    }
-    free(best_selection);
-}
-
-/* 动态规划法 */
-void dynamic_programming_knapsack(Item* items, int n, int C, const char* csv_filename) {
-    clock_t start = clock();
-    
-    printf("动态规划法开始计算（创建 %d x %d 的DP表）...\n", n+1, C+1);
-    
-    double** dp = (double**)malloc((n + 1) * sizeof(double*));
-    int** keep = (int**)malloc((n + 1) * sizeof(int*));
-    int i, w, current_cap;
-    
-    if (!dp || !keep) {
-        printf("动态规划法内存分配失败。\n");
-        if (dp) free(dp);
-        if (keep) free(keep);
-        return;
-    }
-
-    for (i = 0; i <= n; i++) {
-        dp[i] = (double*)malloc((C + 1) * sizeof(double));
-        keep[i] = (int*)malloc((C + 1) * sizeof(int));
-        if (!dp[i] || !keep[i]) {
-            int k;
-            printf("动态规划法DP表内存分配失败。\n");
-            for(k = 0; k < i; k++) { 
-                free(dp[k]); 
-                free(keep[k]); 
-            }
-            free(dp); 
-            free(keep);
-            return;
-        }
-    }
-    
-    /* 填充DP表 */
-    for (i = 0; i <= n; i++) {
-        for (w = 0; w <= C; w++) {
-            if (i == 0 || w == 0) {
-                dp[i][w] = 0;
-                keep[i][w] = 0;
-            } else if (items[i-1].weight <= w) {
-                double value_if_taken = items[i-1].value + dp[i-1][w - items[i-1].weight];
-                double value_if_not_taken = dp[i-1][w];
-                if (value_if_taken > value_if_not_taken) {
-                    dp[i][w] = value_if_taken;
-                    keep[i][w] = 1;
-                } else {
-                    dp[i][w] = value_if_not_taken;
-                    keep[i][w] = 0;
-                }
-            } else {
-                dp[i][w] = dp[i-1][w];
-                keep[i][w] = 0;
-            }
-        }
-        
-        /* 进度显示 */
-        if (i > 0 && (i % (n/10) == 0 || i == n)) {
-            printf("DP表填充进度: %d/%d (%.1f%%)\n", i, n, (double)i / n * 100);
-        }
-    }
-
-    /* 重构解 */
-    {
-        int* selection = (int*)calloc(n, sizeof(int));
-        if (selection) {
-            current_cap = C;
-            for (i = n; i > 0; i--) {
-                if (keep[i][current_cap] == 1) {
-                    selection[i-1] = 1;
-                    current_cap -= items[i-1].weight;
-                }
-            }
-            
-            clock_t end = clock();
-            double execution_time = ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
-            
-            print_solution("动态规划法", items, selection, n, C, execution_time);
-            if (csv_filename) {
-                write_to_csv(csv_filename, "动态规划法", items, selection, n, C, execution_time);
-            }
-            free(selection);
-        }
-    }
-
-    /* 释放内存 */
-    for (i = 0; i <= n; i++) {
-        free(dp[i]);
-        free(keep[i]);
-    }
-    free(dp);
-    free(keep);
-}
-
-/* 贪心法 */
-void greedy_knapsack(Item* items, int n, int C, const char* csv_filename) {
-    clock_t start = clock();
-    
-    printf("贪心法开始计算（按价值密度排序）...\n");
-    
-    Item* sorted_items = (Item*)malloc(n * sizeof(Item));
-    int current_weight = 0;
-    int* selection;
-    int i;
-    
-    if (!sorted_items) {
-        printf("贪心法内存分配失败。\n");
-        return;
-    }
-    memcpy(sorted_items, items, n * sizeof(Item));
-    qsort(sorted_items, n, sizeof(Item), compareItems);
-
-    selection = (int*)calloc(n, sizeof(int));
-    if (!selection) {
-        printf("贪心法选择数组内存分配失败。\n");
-        free(sorted_items);
-        return;
-    }
-
-    for (i = 0; i < n; i++) {
-        if (current_weight + sorted_items[i].weight <= C) {
-            selection[sorted_items[i].id - 1] = 1;
-            current_weight += sorted_items[i].weight;
-        }
-    }
-
-    clock_t end = clock();
-    double execution_time = ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
-    
-    print_solution("贪心法", items, selection, n, C, execution_time);
-    if (csv_filename) {
-        write_to_csv(csv_filename, "贪心法", items, selection, n, C, execution_time);
-    }
-    
-    free(sorted_items);
-    free(selection);
-}
-
-/* 回溯法辅助函数 */
-double calculate_bound(int index, int current_weight, double current_value) {
-    double bound = current_value;
-    int remaining_capacity = g_backtracking_capacity - current_weight;
-    int i = index;
-
-    while (i < g_backtracking_num_items && g_backtracking_items[i].weight <= remaining_capacity) {
-        remaining_capacity -= g_backtracking_items[i].weight;
-        bound += g_backtracking_items[i].value;
-        i++;
-    }
-
-    if (i < g_backtracking_num_items) {
-        bound += (double)remaining_capacity * g_backtracking_items[i].density;
-    }
-
-    return bound;
-}
-
-void backtrack_recursive(int index, int current_weight, double current_value, int* current_selection) {
-    if (index == g_backtracking_num_items) {
-        if (current_value > g_backtracking_max_value) {
-            g_backtracking_max_value = current_value;
-            memcpy(g_backtracking_best_selection, current_selection, g_backtracking_num_items * sizeof(int));
-        }
-        return;
-    }
-
-    if (calculate_bound(index, current_weight, current_value) <= g_backtracking_max_value) {
-        return;
-    }
-
-    if (current_weight + g_backtracking_items[index].weight <= g_backtracking_capacity) {
-        current_selection[index] = 1;
-        backtrack_recursive(index + 1, current_weight + g_backtracking_items[index].weight, current_value + g_backtracking_items[index].value, current_selection);
-    }
-
-    current_selection[index] = 0;
-    backtrack_recursive(index + 1, current_weight, current_value, current_selection);
-}
-
-/* 回溯法 */
-void backtracking_knapsack(Item* items, int n, int C, const char* csv_filename) {
-    clock_t start = clock();
-    
-    printf("回溯法开始计算（带剪枝优化）...\n");
-    
-    Item* sorted_items = (Item*)malloc(n * sizeof(Item));
-    int* current_selection;
-    int* final_selection;
-    int i;
-    
-    if(!sorted_items) { 
-        printf("回溯法内存分配失败。\n"); 
-        return; 
-    }
-    memcpy(sorted_items, items, n * sizeof(Item));
-    qsort(sorted_items, n, sizeof(Item), compareItems);
-
-    g_backtracking_items = sorted_items;
-    g_backtracking_num_items = n;
-    g_backtracking_capacity = C;
-    g_backtracking_max_value = 0.0;
-    
-    g_backtracking_best_selection = (int*)calloc(n, sizeof(int));
-    current_selection = (int*)calloc(n, sizeof(int));
-    if (!g_backtracking_best_selection || !current_selection) {
-        printf("回溯法选择数组内存分配失败。\n");
-        if(sorted_items) free(sorted_items);
-        if(g_backtracking_best_selection) free(g_backtracking_best_selection);
-        if(current_selection) free(current_selection);
-        return;
-    }
-
-    backtrack_recursive(0, 0, 0.0, current_selection);
-    
-    final_selection = (int*)calloc(n, sizeof(int));
-    if (final_selection) {
-        for(i = 0; i < n; i++) {
-            if(g_backtracking_best_selection[i] == 1) {
-                final_selection[sorted_items[i].id - 1] = 1;
-            }
-        }
-        
-        clock_t end = clock();
-        double execution_time = ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
-        
-        print_solution("回溯法", items, final_selection, n, C, execution_time);
-        if (csv_filename) {
-            write_to_csv(csv_filename, "回溯法", items, final_selection, n, C, execution_time);
-        }
-        free(final_selection);
-    }
-    
-    free(sorted_items);
-    free(g_backtracking_best_selection);
-    free(current_selection);
-}
-
-/* 显示菜单 */
-void show_menu() {
-    printf("\n=========== 0-1背包问题===========\n");
-    printf("支持的物品数量: 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000, 20000, 40000, 80000, 160000, 320000\n");
-    printf("支持的背包容量: 10000, 100000, 1000000\n");
-    printf("物品重量范围: 1-100\n");
-    printf("物品价值范围: 100.00-1000.00\n");
-    printf("================================================\n");
-}
-
-/* 检查输入有效性 */
-int is_valid_n(int n) {
-    int valid_n[] = {1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000, 20000, 40000, 80000, 160000, 320000};
-    int i;
-    for (i = 0; i < sizeof(valid_n)/sizeof(valid_n[0]); i++) {
-        if (n == valid_n[i]) return 1;
-    }
-    return 0;
-}
-
-int is_valid_capacity(int capacity) {
-    return (capacity == 10000 || capacity == 100000 || capacity == 1000000);
-}
-
-/* 算法可行性检查 */
-void check_algorithm_feasibility(int n, int capacity) {
-    printf("\n============ 算法可行性分析 ============\n");
-    
-    /* 贪心法 - 总是可行 */
-    printf("✓ 贪心法: 可行 (时间复杂度: O(n log n))\n");
-    
-    /* 动态规划法 */
-    long long dp_complexity = (long long)n * capacity;
-    if (dp_complexity <= 400000000LL) {  /* 4亿的阈值 */
-        printf("✓ 动态规划法: 可行 (时间复杂度: O(n×C) = %lld)\n", dp_complexity);
-    } else {
-        printf("✗ 动态规划法: 不可行 (时间复杂度过高: %lld > 4亿)\n", dp_complexity);
-    }
-    
-    /* 回溯法 */
-    if (n <= 25) {
-        printf("✓ 回溯法: 可行 (但可能较慢)\n");
-    } else {
-        printf("✗ 回溯法: 不可行 (N=%d > 25, 时间复杂度: O(2^%d))\n", n, n);
-    }
-    
-    /* 蛮力法 */
-    if (n <= 25) {
-        printf("✓ 蛮力法: 可行 (但会很慢)\n");
-    } else {
-        printf("✗ 蛮力法: 不可行 (N=%d > 25, 需要检查 2^%d 种组合)\n", n, n);
-    }
-    
-    printf("========================================\n\n");
-}
-
-/* 主函数 */
-int main() {
-    int n, capacity, choice;
-    Item* items = NULL;
-    clock_t program_start, program_end;
-    char csv_filename[100];
-    char student_info[100];
-    
-    srand((unsigned int)time(NULL));
-    
-    #if defined(_WIN32) || defined(_WIN64)
-    SetConsoleOutputCP(65001);
-    #endif
-
-    // 获取学生信息用于文件名
-    printf("请输入学号-姓名 (例如: 20231060000-张三): ");
-    scanf("%s", student_info);
-    sprintf(csv_filename, "%s-数据.csv", student_info);
-    
-    // 初始化CSV文件，写入表头
-    FILE* fp = fopen(csv_filename, "w");
-    if (fp) {
-        fprintf(fp, "0-1背包问题实验数据\n\n");
-        fclose(fp);
-    } else {
-        printf("无法创建CSV文件: %s\n", csv_filename);
-        return 1;
-    }
-
-    while (1) {
-        show_menu();
-        
-        /* 输入物品数量 */
-        printf("请输入物品数量 (输入0退出): ");
-        if (scanf("%d", &n) != 1) {
-            printf("输入无效，请重新输入。\n");
-            while (getchar() != '\n');  /* 清空输入缓冲区 */
-            continue;
-        }
-        
-        if (n == 0) {
-            printf("程序退出。\n");
-            break;
-        }
-        
-        if (!is_valid_n(n)) {
-            printf("无效的物品数量！请选择支持的数量。\n");
-            continue;
-        }
-        
-        /* 输入背包容量 */
-        printf("请输入背包容量: ");
-        if (scanf("%d", &capacity) != 1) {
-            printf("输入无效，请重新输入。\n");
-            while (getchar() != '\n');
-            continue;
-        }
-        
-        if (!is_valid_capacity(capacity)) {
-            printf("无效的背包容量！请选择: 10000, 100000, 或 1000000。\n");
-            continue;
-        }
-        
-        /* 生成物品数据 */
-        printf("\n正在为 N=%d, C=%d 生成测试数据...\n", n, capacity);
-        items = (Item*)malloc(n * sizeof(Item));
-        if (!items) {
-            printf("内存分配失败！\n");
-            continue;
-        }
-        
-        generate_items(items, n);
-        
-        /* 分析算法可行性 */
-        check_algorithm_feasibility(n, capacity);
-        
-        /* 记录程序开始时间（不包含数据生成时间） */
-        program_start = clock();
-        
-        /* 选择要运行的算法 */
-        printf("请选择要运行的算法:\n");
-        printf("1. 贪心法\n");
-        printf("2. 动态规划法\n");
-        printf("3. 回溯法\n");
-        printf("4. 蛮力法\n");
-        printf("5. 运行所有可行的算法\n");
-        printf("选择 (1-5): ");
-        
-        if (scanf("%d", &choice) != 1) {
-            printf("输入无效。\n");
-            free(items);
-            while (getchar() != '\n');
-            continue;
-        }
-        
-        printf("\n开始算法测试...\n");
-        printf("======================================\n");
-        
-        switch (choice) {
-            case 1:
-                greedy_knapsack(items, n, capacity, csv_filename);
-                break;
-                
-            case 2:
-                if ((long long)n * capacity <= 400000000LL) {
-                    dynamic_programming_knapsack(items, n, capacity, csv_filename);
-                } else {
-                    printf("动态规划法: 问题规模过大，跳过执行。\n");
-                }
-                break;
-                
-            case 3:
-                if (n <= 25) {
-                    backtracking_knapsack(items, n, capacity, csv_filename);
-                } else {
-                    printf("回溯法: N=%d 过大，跳过执行。\n", n);
-                }
-                break;
-                
-            case 4:
-                if (n <= 25) {
-                    brute_force_knapsack(items, n, capacity, csv_filename);
-                } else {
-                    printf("蛮力法: N=%d 过大，跳过执行。\n", n);
-                }
-                break;
-                
-            case 5:
-                /* 贪心法 */
-                greedy_knapsack(items, n, capacity, csv_filename);
-                
-                /* 动态规划法 */
-                if ((long long)n * capacity <= 400000000LL) {
-                    dynamic_programming_knapsack(items, n, capacity, csv_filename);
-                } else {
-                    printf("动态规划法: 问题规模过大，跳过执行。\n\n");
-                }
-                
-                /* 回溯法 */
-                if (n <= 25) {
-                    backtracking_knapsack(items, n, capacity, csv_filename);
-                } else {
-                    printf("回溯法: N=%d 过大，跳过执行。\n\n", n);
-                }
-                
-                /* 蛮力法 */
-                if (n <= 25) {
-                    brute_force_knapsack(items, n, capacity, csv_filename);
-                } else {
-                    printf("蛮力法: N=%d 过大，跳过执行。\n\n", n);
-                }
-                break;
-                
-            default:
-                printf("无效选择。\n");
-                break;
-        }
-        
-        /* 记录程序结束时间 */
-        program_end = clock();
-        double total_execution_time = ((double)(program_end - program_start)) / CLOCKS_PER_SEC * 1000.0;
-        
-        printf("======================================\n");
-        printf("程序总执行时间: %.2f ms\n", total_execution_time);
-        printf("======================================\n\n");
-        
-        free(items);
-        
-        /* 询问是否继续 */
-        printf("是否继续测试其他配置? (y/n): ");
-        char continue_choice;
-        scanf(" %c", &continue_choice);
-        if (continue_choice != 'y' && continue_choice != 'Y') {
-            break;
-        }
-    }
-    
-    printf("测试完成！数据已保存至: %s\n", csv_filename);
-    printf("该文件可以直接用Excel打开，或转换为xlsx格式。\n");
-    return 0;
-}
\ No newline at end of file
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <float.h>
+#include <stdatomic.h>
+
+#include "knapsack.h"
+#include "knapsack_kernel.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#endif
+
+/* 上界 ub 能否证明无法超过当前最优值 z（整数价值时上界可以向下取整） */
+#if VALUE_IS_INTEGER
+#define BOUND_CANNOT_IMPROVE(ub, z) ((ub) < (double)(z) + 1.0)
+#else
+#define BOUND_CANNOT_IMPROVE(ub, z) ((ub) <= (double)(z))
+#endif
+
+/* 墙钟时间（毫秒，单调递增），用于标定和分阶段计时；多线程时 clock() 统计的是所有线程的CPU时间之和 */
+double wall_time_ms(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+/* 结束当前阶段并开始 phase：上一阶段经过的墙钟时间计入 result->phase_ms */
+void solver_phase(KnapsackSolver* solver, KnapsackResult* result, KnapsackPhase phase) {
+    double now = wall_time_ms();
+    result->phase_ms[solver->phase] += now - solver->phase_start;
+    solver->phase = phase;
+    solver->phase_start = now;
+}
+
+/*
+ * 硬件计数器（solver->perf 非0时）：周期、指令、最后一级缓存未命中各开一个 perf_event，
+ * 只统计调用线程的用户态（pid 0，不继承）：DP填表、并行蛮力法、并行回溯法等多线程算法中
+ * 其他线程的工作不计入，输出和运行记录都标明"调用线程"；OpenMP 线程池在之前的并行区已经建好，
+ * 设置 inherit 也只能覆盖一部分线程，所以不设。某个事件打不开（非Linux、权限不足、虚拟机不支持）时对应结果为 -1。
+ */
+#define PERF_COUNTERS 3
+
+void perf_counters_start(int* fds) {
+#if defined(__linux__)
+    static const unsigned long long configs[PERF_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+    };
+    struct perf_event_attr attr;
+    int k;
+
+    for (k = 0; k < PERF_COUNTERS; k++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[k];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fds[k] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds[k] >= 0) {
+            ioctl(fds[k], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[k], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    int k;
+    for (k = 0; k < PERF_COUNTERS; k++) {
+        fds[k] = -1;
+    }
+#endif
+}
+
+void perf_counters_stop(int* fds, KnapsackResult* result) {
+    long long* out[PERF_COUNTERS];
+    int k;
+
+    out[0] = &result->perf_cycles;
+    out[1] = &result->perf_instructions;
+    out[2] = &result->perf_cache_misses;
+    for (k = 0; k < PERF_COUNTERS; k++) {
+        long long count = -1;
+#if defined(__linux__)
+        if (fds[k] >= 0) {
+            ioctl(fds[k], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fds[k], &count, sizeof(count)) != (ssize_t)sizeof(count)) {
+                count = -1;
+            }
+            close(fds[k]);
+        }
+#endif
+        *out[k] = count;
+    }
+}
+
+/* 比较函数，用于按密度降序排序 */
+int compareItems(const void* a, const void* b) {
+    Item* itemA = (Item*)a;
+    Item* itemB = (Item*)b;
+    if (itemB->density > itemA->density) return 1;
+    if (itemB->density < itemA->density) return -1;
+    return 0;
+}
+
+/* 内存池溢出块的头部，块内数据紧跟其后 */
+struct KnapsackArenaChunk {
+    KnapsackArenaChunk* next;
+};
+
+#define KNAPSACK_ARENA_ALIGN 64
+
+void knapsack_arena_init(KnapsackArena* arena) {
+    memset(arena, 0, sizeof(*arena));
+    arena->retain_limit = KNAPSACK_ARENA_RETAIN;
+}
+
+void* knapsack_arena_alloc(KnapsackArena* arena, size_t bytes) {
+    size_t offset = (arena->used + KNAPSACK_ARENA_ALIGN - 1) & ~(size_t)(KNAPSACK_ARENA_ALIGN - 1);
+    KnapsackArenaChunk* chunk;
+    size_t total;
+
+    if (bytes == 0) bytes = 1;
+    if (arena->base && offset + bytes <= arena->capacity) {
+        arena->used = offset + bytes;
+        if (arena->used + arena->overflow_bytes > arena->peak) {
+            arena->peak = arena->used + arena->overflow_bytes;
+        }
+        return arena->base + offset;
+    }
+
+    /* 主块放不下：单独分配一个溢出块，下次 reset 时并入主块 */
+    total = sizeof(KnapsackArenaChunk) + KNAPSACK_ARENA_ALIGN + bytes;
+    chunk = (KnapsackArenaChunk*)malloc(total);
+    if (!chunk) {
+        return NULL;
+    }
+    chunk->next = arena->overflow;
+    arena->overflow = chunk;
+    arena->overflow_bytes += bytes + KNAPSACK_ARENA_ALIGN;
+    if (arena->used + arena->overflow_bytes > arena->peak) {
+        arena->peak = arena->used + arena->overflow_bytes;
+    }
+    return (void*)(((size_t)(chunk + 1) + KNAPSACK_ARENA_ALIGN - 1) & ~(size_t)(KNAPSACK_ARENA_ALIGN - 1));
+}
+
+void* knapsack_arena_calloc(KnapsackArena* arena, size_t count, size_t size) {
+    void* p = knapsack_arena_alloc(arena, count * size);
+    if (p) {
+        memset(p, 0, count * size);
+    }
+    return p;
+}
+
+void knapsack_arena_reset(KnapsackArena* arena) {
+    while (arena->overflow) {
+        KnapsackArenaChunk* next = arena->overflow->next;
+        free(arena->overflow);
+        arena->overflow = next;
+    }
+    if (arena->peak > arena->capacity && arena->peak <= arena->retain_limit) {
+        size_t capacity = (arena->peak + 65535) & ~(size_t)65535;
+        unsigned char* base = (unsigned char*)malloc(capacity);
+        if (base) {
+            free(arena->base);
+            arena->base = base;
+            arena->capacity = capacity;
+        }
+    }
+    arena->used = 0;
+    arena->overflow_bytes = 0;
+    arena->peak = 0;
+}
+
+void knapsack_arena_free(KnapsackArena* arena) {
+    arena->peak = 0;
+    knapsack_arena_reset(arena);
+    free(arena->base);
+    knapsack_arena_init(arena);
+}
+
+/* 物品文件 */
+#define KNAPSACK_ITEM_FILE_ALIGN 64
+
+/* 从 offset 开始的 n 个 elem 字节的元素是否在文件头之后、映射之内；先比较再做除法，offset 和 n 取任何值都不会溢出 */
+int item_file_column_fits(long long offset, long long n, size_t elem, size_t map_size) {
+    return offset >= (long long)sizeof(KnapsackItemFileHeader)
+        && (unsigned long long)offset <= (unsigned long long)map_size
+        && (unsigned long long)n <= ((unsigned long long)map_size - (unsigned long long)offset) / elem;
+}
+
+int knapsack_item_file_open(KnapsackItemFile* file, const char* path) {
+    const KnapsackItemFileHeader* header;
+    long long n;
+
+    memset(file, 0, sizeof(*file));
+#if defined(_WIN32) || defined(_WIN64)
+    {
+        HANDLE fh = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        LARGE_INTEGER size;
+        if (fh == INVALID_HANDLE_VALUE) {
+            return KNAPSACK_ERR_IO;
+        }
+        if (!GetFileSizeEx(fh, &size) || size.QuadPart < (LONGLONG)sizeof(KnapsackItemFileHeader)) {
+            CloseHandle(fh);
+            return KNAPSACK_ERR_IO;
+        }
+        file->mapping = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(fh);    /* 映射对象持有文件 */
+        if (!file->mapping) {
+            return KNAPSACK_ERR_IO;
+        }
+        file->map = MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0);
+        file->map_size = (size_t)size.QuadPart;
+        if (!file->map) {
+            CloseHandle(file->mapping);
+            file->mapping = NULL;
+            return KNAPSACK_ERR_IO;
+        }
+    }
+#else
+    {
+        struct stat st;
+        int fd = open(path, O_RDONLY);
+        void* map;
+        if (fd < 0) {
+            return KNAPSACK_ERR_IO;
+        }
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(KnapsackItemFileHeader)) {
+            close(fd);
+            return KNAPSACK_ERR_IO;
+        }
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);          /* 映射建立后不再需要文件描述符 */
+        if (map == MAP_FAILED) {
+            return KNAPSACK_ERR_IO;
+        }
+        madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+        file->map = map;
+        file->map_size = (size_t)st.st_size;
+    }
+#endif
+
+    /* 只检查文件头和各列的范围，不扫描数据，打开的耗时与 n 无关 */
+    header = (const KnapsackItemFileHeader*)file->map;
+    n = header->n;
+    if (memcmp(header->magic, KNAPSACK_ITEM_FILE_MAGIC, sizeof(KNAPSACK_ITEM_FILE_MAGIC)) != 0
+        || header->version != KNAPSACK_ITEM_FILE_VERSION
+        || header->weight_bytes != sizeof(int) || header->value_bytes != sizeof(long long)
+        || n < 0 || n > INT_MAX
+        || header->weight_offset % KNAPSACK_ITEM_FILE_ALIGN || header->value_offset % KNAPSACK_ITEM_FILE_ALIGN
+        || !item_file_column_fits(header->weight_offset, n, sizeof(int), file->map_size)
+        || !item_file_column_fits(header->value_offset, n, sizeof(long long), file->map_size)) {
+        knapsack_item_file_close(file);
+        return KNAPSACK_ERR_IO;
+    }
+    file->n = (int)n;
+    file->max_weight = header->max_weight;
+    file->weight = (const int*)((const unsigned char*)file->map + header->weight_offset);
+    file->value_cents = (const long long*)((const unsigned char*)file->map + header->value_offset);
+    return KNAPSACK_OK;
+}
+
+void knapsack_item_file_close(KnapsackItemFile* file) {
+#if defined(_WIN32) || defined(_WIN64)
+    if (file->map) UnmapViewOfFile(file->map);
+    if (file->mapping) CloseHandle(file->mapping);
+#else
+    if (file->map) munmap(file->map, file->map_size);
+#endif
+    memset(file, 0, sizeof(*file));
+}
+
+int knapsack_item_file_items(const KnapsackItemFile* file, Item* items) {
+    int i;
+    for (i = 0; i < file->n; i++) {
+        if (file->weight[i] <= 0 || file->value_cents[i] < 0 || file->value_cents[i] > VALUE_CENTS_MAX) {
+            return KNAPSACK_ERR_INVALID;
+        }
+        items[i].id = i + 1;
+        items[i].weight = file->weight[i];
+        items[i].value = VALUE_FROM_CENTS(file->value_cents[i]);
+        items[i].density = (double)items[i].value / items[i].weight;
+    }
+    return KNAPSACK_OK;
+}
+
+/* 写文件头；各列的位置由 n 决定：重量列紧跟文件头，价值列在其后对齐 */
+void item_file_header(KnapsackItemFileHeader* header, long long n, int max_weight) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, KNAPSACK_ITEM_FILE_MAGIC, sizeof(KNAPSACK_ITEM_FILE_MAGIC));
+    header->version = KNAPSACK_ITEM_FILE_VERSION;
+    header->weight_bytes = sizeof(int);
+    header->value_bytes = sizeof(long long);
+    header->n = n;
+    header->max_weight = max_weight;
+    header->weight_offset = sizeof(KnapsackItemFileHeader);
+    header->value_offset = (header->weight_offset + n * (long long)sizeof(int) + KNAPSACK_ITEM_FILE_ALIGN - 1)
+                           / KNAPSACK_ITEM_FILE_ALIGN * KNAPSACK_ITEM_FILE_ALIGN;
+}
+
+/* 补零到 offset 处 */
+int item_file_pad(FILE* fp, long long offset) {
+    static const char zeros[KNAPSACK_ITEM_FILE_ALIGN];
+    long long pos = ftell(fp);
+    return pos >= 0 && pos <= offset && fwrite(zeros, 1, (size_t)(offset - pos), fp) == (size_t)(offset - pos);
+}
+
+int knapsack_item_file_write(const char* path, const Item* items, int n) {
+    KnapsackItemFileHeader header;
+    FILE* fp = fopen(path, "wb");
+    int i, max_weight = 0, ok;
+
+    if (!fp) {
+        return KNAPSACK_ERR_IO;
+    }
+    for (i = 0; i < n; i++) {
+        if (items[i].weight > max_weight) max_weight = items[i].weight;
+    }
+    item_file_header(&header, n, max_weight);
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    for (i = 0; i < n && ok; i++) {
+        ok = fwrite(&items[i].weight, sizeof(int), 1, fp) == 1;
+    }
+    ok = ok && item_file_pad(fp, header.value_offset);
+    for (i = 0; i < n && ok; i++) {
+        long long cents = VALUE_TO_CENTS(items[i].value);
+        ok = fwrite(&cents, sizeof(cents), 1, fp) == 1;
+    }
+    if (fclose(fp) != 0) ok = 0;
+    return ok ? KNAPSACK_OK : KNAPSACK_ERR_IO;
+}
+
+/* 把"123.45"形式的元解析为分（第三位小数四舍五入），不是数字返回0，超出 long long 的分数返回-1 */
+int parse_cents(const char* text, long long* cents, const char** end) {
+    long long whole = 0;
+    int frac = 0, digits = 0, any = 0;
+    while (*text == ' ' || *text == '\t') text++;
+    while (*text >= '0' && *text <= '9') {
+        int d = *text++ - '0';
+        /* 最后还要乘100再加上最多100分的小数部分 */
+        if (whole > ((LLONG_MAX - 100) / 100 - d) / 10) {
+            return -1;
+        }
+        whole = whole * 10 + d;
+        any = 1;
+    }
+    if (*text == '.') {
+        text++;
+        while (*text >= '0' && *text <= '9') {
+            if (digits < 2) {
+                frac = frac * 10 + (*text - '0');
+            } else if (digits == 2 && *text >= '5') {
+                frac++;
+            }
+            digits++;
+            any = 1;
+            text++;
+        }
+    }
+    if (digits == 1) frac *= 10;
+    *cents = whole * 100 + frac;
+    *end = text;
+    return any;
+}
+
+/*
+ * 流式导入：逐行解析，重量直接写入输出文件的重量列，价值先写入临时文件，
+ * 读完后再接到价值列的位置并补写文件头。内存占用与行数无关。
+ */
+int knapsack_item_file_import_csv(const char* csv_path, const char* path, int* imported) {
+    KnapsackItemFileHeader header;
+    FILE* in = fopen(csv_path, "r");
+    FILE* out = in ? fopen(path, "wb") : NULL;
+    FILE* values = out ? tmpfile() : NULL;
+    char line[512];
+    long long n = 0, line_no = 0, bad_line = 0;
+    int max_weight = 0, ok = 1;
+
+    if (imported) *imported = 0;
+    if (!in || !out || !values) {
+        if (in) fclose(in);
+        if (out) fclose(out);
+        if (values) fclose(values);
+        return KNAPSACK_ERR_IO;
+    }
+    memset(&header, 0, sizeof(header));
+    ok = fwrite(&header, sizeof(header), 1, out) == 1;     /* 先占位 */
+
+    while (ok && fgets(line, sizeof(line), in)) {
+        long long field[3];
+        int count = 0, parsed = 0;
+        const char* p = line;
+        int weight;
+
+        line_no++;
+        /* fgets 在缓冲区满时把长行截断，剩下的部分会被当成下一行：没读到换行且后面还有内容就报错 */
+        if (!strchr(line, '\n')) {
+            int c = getc(in);
+            if (c != EOF && c != '\n') {
+                bad_line = line_no;
+                break;
+            }
+        }
+        if ((unsigned char)p[0] == 0xEF && (unsigned char)p[1] == 0xBB && (unsigned char)p[2] == 0xBF) {
+            p += 3;     /* UTF-8 BOM */
+        }
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '-') {
+            bad_line = line_no;     /* 负的重量或价值 */
+            break;
+        }
+        if (*p < '0' || *p > '9') {
+            continue;   /* 表头或空行 */
+        }
+        while (count < 3 && (parsed = parse_cents(p, &field[count], &p)) > 0) {
+            count++;
+            while (*p == ' ' || *p == '\t') p++;
+            if (*p != ',' && *p != ';' && *p != '\t') break;
+            p++;
+        }
+        /* 重量是整数：按分解析的结果要除回去；价值要能转换为本程序的 value_t */
+        if (parsed < 0 || count < 2 || field[count - 2] % 100 != 0 || field[count - 2] / 100 > INT_MAX
+            || field[count - 2] <= 0 || field[count - 1] > VALUE_CENTS_MAX) {
+            bad_line = line_no;
+            break;
+        }
+        weight = (int)(field[count - 2] / 100);
+        if (weight > max_weight) max_weight = weight;
+        ok = fwrite(&weight, sizeof(int), 1, out) == 1
+             && fwrite(&field[count - 1], sizeof(long long), 1, values) == 1;
+        n++;
+        if (n > INT_MAX) ok = 0;
+    }
+    fclose(in);
+
+    /* 价值列接在重量列之后，再回头写文件头 */
+    item_file_header(&header, n, max_weight);
+    ok = ok && item_file_pad(out, header.value_offset);
+    if (ok) {
+        long long buf[4096];
+        size_t got;
+        rewind(values);
+        while (ok && (got = fread(buf, sizeof(long long), 4096, values)) > 0) {
+            ok = fwrite(buf, sizeof(long long), got, out) == got;
+        }
+    }
+    ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1;
+    fclose(values);
+    if (fclose(out) != 0) ok = 0;
+    if (bad_line) {
+        remove(path);
+        if (imported) *imported = bad_line > INT_MAX ? INT_MAX : (int)bad_line;
+        return KNAPSACK_ERR_INVALID;
+    }
+    if (!ok) {
+        remove(path);
+        return KNAPSACK_ERR_IO;
+    }
+    if (imported) *imported = (int)n;
+    return KNAPSACK_OK;
+}
+
+/* 生成随机实例：物品 i 用计数器 i 调用一次 Philox，v[0] 决定重量、v[1] 决定价值 */
+int knapsack_generate(Item* items, int n, unsigned long long seed, KnapsackInstanceFamily family) {
+    int i;
+    if ((unsigned)family >= KNAPSACK_GEN_COUNT || n < 0 || (n > 0 && !items)) {
+        return KNAPSACK_ERR_INVALID;
+    }
+    #pragma omp parallel for schedule(static) num_threads(dp_threads) if (n >= 65536)
+    for (i = 0; i < n; i++) {
+        philox4x32_t r = philox4x32((unsigned long long)i, 0, seed);
+        int w = 1 + (int)random_below(r.v[0], 100);  /* 1-100之间 */
+        long long cents;
+        switch (family) {
+        case KNAPSACK_GEN_WEAKLY_CORRELATED: {
+            long long lo = w * 1000LL - 10000 > 1000 ? w * 1000LL - 10000 : 1000;
+            cents = lo + random_below(r.v[1], (unsigned int)(w * 1000LL + 10000 - lo + 1));
+            break;
+        }
+        case KNAPSACK_GEN_STRONGLY_CORRELATED:
+            cents = (w + 10) * 1000LL;
+            break;
+        case KNAPSACK_GEN_INVERSE_STRONGLY_CORRELATED: {
+            int p = 1 + (int)random_below(r.v[1], 90);
+            cents = p * 1000LL;
+            w = p + 10;
+            break;
+        }
+        case KNAPSACK_GEN_ALMOST_STRONGLY_CORRELATED:
+            cents = (w + 10) * 1000LL - 200 + random_below(r.v[1], 401);
+            break;
+        case KNAPSACK_GEN_SUBSET_SUM:
+            cents = w * 1000LL;
+            break;
+        default:
+            cents = 10000 + random_below(r.v[1], 90001);  /* 100.00-1000.00之间 */
+            break;
+        }
+        items[i].id = i + 1;
+        items[i].weight = w;
+        items[i].value = VALUE_FROM_CENTS(cents);
+        items[i].density = (double)items[i].value / w;
+    }
+    return KNAPSACK_OK;
+}
+
+const char* instance_family_names[KNAPSACK_GEN_COUNT] = {
+    "不相关", "弱相关", "强相关", "逆强相关", "近强相关", "子集和"
+};
+
+/* 生成随机物品 */
+void generate_items(Item* items, int n, unsigned long long seed, KnapsackInstanceFamily family) {
+    printf("生成 %d 个随机物品（%s实例，种子 %llu）...\n", n, instance_family_names[family], seed);
+    knapsack_generate(items, n, seed, family);
+    printf("物品生成完成。\n\n");
+}
+
+/* 检查所有物品的价值之和能否用 value_t 表示（int32 分值在 N 较大时会溢出） */
+int values_fit_value_type(Item* items, int n) {
+    double sum = 0;
+    int i;
+    for (i = 0; i < n; i++) {
+        sum += (double)items[i].value;
+    }
+    return sum <= (double)VALUE_MAX;
+}
+
+/* 同上，直接读物品文件的价值列 */
+int item_file_values_fit(const KnapsackItemFile* file) {
+    double sum = 0;
+    int i;
+    for (i = 0; i < file->n; i++) {
+        /* 按 value_t 的单位（整数表示为分、double 为元）累加，与 VALUE_MAX 比较 */
+        sum += (double)file->value_cents[i] / (VALUE_IS_INTEGER ? 1.0 : 100.0);
+    }
+    return sum <= (double)VALUE_MAX;
+}
+
+/* 批量测试模式下不打印选中物品清单；print_solution 记录最近一次结果的总价值和总重量 */
+int print_selected_items = 1;
+value_t last_total_value;
+int last_total_weight;
+int last_solve_status = KNAPSACK_OK;    /* console_solve 记录最近一次求解的状态，批量测试据此跳过失败的运行 */
+
+/* 打印解决方案到控制台 */
+void print_solution(const char* method_name, Item* items, int* selection, int n, int capacity, double execution_time) {
+    value_t total_value = 0;
+    int total_weight = 0;
+    int selected_count = 0;
+    int i;
+    
+    printf("\n========== [%s] 算法结果 ==========\n", method_name);
+    printf("执行时间: %.2f ms\n", execution_time);
+    printf("背包容量: %d\n", capacity);
+    if (print_selected_items) {
+        printf("\n选中的物品:\n");
+        printf("%-8s %-8s %-10s\n", "物品编号", "重量", "价值");
+        printf("--------------------------------\n");
+    }
+    
+    for (i = 0; i < n; i++) {
+        if (selection[i]) {
+            if (print_selected_items) {
+                printf("%-8d %-8d %-10.2f\n", items[i].id, items[i].weight, VALUE_TO_DOUBLE(items[i].value));
+            }
+            total_value += items[i].value;
+            total_weight += items[i].weight;
+            selected_count++;
+        }
+    }
+    last_total_value = total_value;
+    last_total_weight = total_weight;
+    
+    printf("--------------------------------\n");
+    printf("选中物品数量: %d\n", selected_count);
+    printf("总重量: %d\n", total_weight);
+    printf("总价值: %.2f\n", VALUE_TO_DOUBLE(total_value));
+    printf("容量利用率: %.2f%%\n", (double)total_weight / capacity * 100);
+    printf("==========================================\n\n");
+}
+
+/* 将算法结果写入CSV文件 */
+void write_to_csv(const char* filename, const char* method_name, Item* items, int* selection, int n, int capacity, double execution_time) {
+    FILE* fp = fopen(filename, "a");
+    if (!fp) {
+        printf("无法打开CSV文件进行写入: %s\n", filename);
+        return;
+    }
+    
+    value_t total_value = 0;
+    int total_weight = 0;
+    int selected_count = 0;
+    int i;
+    
+    // 写入算法执行摘要
+    fprintf(fp, "算法: %s\n", method_name);
+    fprintf(fp, "执行时间: %.2f ms\n", execution_time);
+    fprintf(fp, "背包容量: %d\n", capacity);
+    fprintf(fp, "\n");
+    
+    // 写入选中的物品表头
+    fprintf(fp, "物品编号,重量,价值\n");
+    
+    // 写入选中的物品数据
+    for (i = 0; i < n; i++) {
+        if (selection[i]) {
+            fprintf(fp, "%d,%d,%.2f\n", items[i].id, items[i].weight, VALUE_TO_DOUBLE(items[i].value));
+            total_value += items[i].value;
+            total_weight += items[i].weight;
+            selected_count++;
+        }
+    }
+    
+    // 写入摘要统计
+    fprintf(fp, "\n");
+    fprintf(fp, "选中物品数量: %d\n", selected_count);
+    fprintf(fp, "总重量: %d\n", total_weight);
+    fprintf(fp, "总价值: %.2f\n", VALUE_TO_DOUBLE(total_value));
+    fprintf(fp, "容量利用率: %.2f%%\n", (double)total_weight / capacity * 100);
+    fprintf(fp, "==========================================\n\n");
+    
+    fclose(fp);
+}
+
+/* 控制台程序（菜单、批量测试）共用的求解器，内存池在多次运行之间复用 */
+KnapsackSolver console_solver;
+int console_solver_ready = 0;
+int console_perf = 0;                   /* 环境变量 KNAPSACK_PERF 或批量测试 --perf 1 打开硬件计数 */
+long long console_bb_node_limit = 100000000LL;  /* 并行回溯法的结点上限，环境变量 KNAPSACK_BB_NODES，0 表示不限 */
+const char* run_record_path = NULL;     /* 环境变量 KNAPSACK_RUN_LOG 或批量测试 --record 指定的运行记录文件 */
+const char* run_record_kernel = "";     /* 运行记录里的DP行内核名称 */
+
+/* 进度回调：user 为进度前缀 */
+void console_progress(void* user, long long done, long long total) {
+    printf("%s: %lld / %lld (%.1f%%)\n", (const char*)user, done, total, (double)done / total * 100);
+}
+
+/* 初始化控制台求解器（只做一次）并设置本次求解的硬件计数、结点上限和进度回调 */
+void console_solver_prepare(const char* progress_label) {
+    if (!console_solver_ready) {
+        knapsack_solver_init(&console_solver);
+        console_solver_ready = 1;
+    }
+    console_solver.perf = console_perf;
+    console_solver.node_limit = console_bb_node_limit;
+    console_solver.progress = progress_label ? console_progress : NULL;
+    console_solver.progress_user = (void*)progress_label;
+}
+
+/* 用控制台求解器求解，失败时打印原因并返回0 */
+int console_solve(const char* method_name, Item* items, int n, int C, KnapsackAlgorithm algo,
+                  const char* progress_label, KnapsackResult* result) {
+    int status;
+    console_solver_prepare(progress_label);
+    status = knapsack_solve(&console_solver, items, n, C, algo, result);
+    last_solve_status = status;
+    if (status == KNAPSACK_ERR_NOMEM) {
+        printf("%s内存分配失败。\n", method_name);
+    } else if (status == KNAPSACK_ERR_TOO_LARGE) {
+        printf("%s: N=%d 超出规模限制。\n", method_name, n);
+    } else if (status != KNAPSACK_OK) {
+        printf("%s: 参数无效。\n", method_name);
+    }
+    return status == KNAPSACK_OK;
+}
+
+/* 求解状态的简短说明 */
+const char* status_text(int status) {
+    switch (status) {
+        case KNAPSACK_OK:            return "成功";
+        case KNAPSACK_ERR_NOMEM:     return "内存分配失败";
+        case KNAPSACK_ERR_TOO_LARGE: return "超出规模限制";
+        case KNAPSACK_ERR_IO:        return "物品文件读写失败";
+        default:                     return "参数无效";
+    }
+}
+
+/*
+ * 运行记录：每次求解追加一行CSV（文件为空时先写表头），包含各阶段耗时、算法计数和硬件计数，
+ * 便于跨版本、跨机器比较同一配置，找出是哪一阶段变慢。不适用的计数为 0，硬件计数不可用时为 -1。
+ */
+void write_run_record(const char* path, const char* method_name, int n, int C, const KnapsackResult* result,
+                      double output_ms) {
+    FILE* fp = fopen(path, "a");
+    char value_text[32] = "";
+    if (!fp) {
+        printf("无法写入运行记录: %s\n", path);
+        return;
+    }
+    /* 位集子集和法（reachable > 0）选的是最大重量的子集，不是价值最优解，总价值留空 */
+    if (result->reachable == 0) {
+        snprintf(value_text, sizeof(value_text), "%.2f", VALUE_TO_DOUBLE(result->total_value));
+    }
+    if (ftell(fp) == 0) {
+        fprintf(fp, "算法,N,C,状态,总价值,总重量,分配 (ms),排序 (ms),填表 (ms),重构 (ms),输出 (ms),"
+                    "访问结点,剪枝结点,计算格子,跳过格子,检查掩码,CPU周期(调用线程),指令数(调用线程),缓存未命中(调用线程),线程数,DP行内核,价值类型\n");
+    }
+    fprintf(fp, "%s,%d,%d,%d,%s,%lld,%.4f,%.4f,%.4f,%.4f,%.4f,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%d,%s,%s\n",
+            method_name, n, C, result->status, value_text, result->total_weight,
+            result->phase_ms[KNAPSACK_PHASE_ALLOC], result->phase_ms[KNAPSACK_PHASE_SORT],
+            result->phase_ms[KNAPSACK_PHASE_FILL], result->phase_ms[KNAPSACK_PHASE_RECONSTRUCT], output_ms,
+            result->nodes, result->pruned, result->cells_computed, result->cells_skipped, result->masks,
+            result->perf_cycles, result->perf_instructions, result->perf_cache_misses,
+            dp_threads, run_record_kernel, VALUE_TYPE_NAME);
+    fclose(fp);
+}
+
+/* 打印分阶段耗时、算法计数和硬件计数，并按需追加运行记录 */
+void report_phases(const char* method_name, int n, int C, const KnapsackResult* result, double output_ms) {
+    printf("分阶段耗时: 分配 %.3f ms，排序 %.3f ms，填表 %.3f ms，重构 %.3f ms，输出 %.3f ms\n",
+           result->phase_ms[KNAPSACK_PHASE_ALLOC], result->phase_ms[KNAPSACK_PHASE_SORT],
+           result->phase_ms[KNAPSACK_PHASE_FILL], result->phase_ms[KNAPSACK_PHASE_RECONSTRUCT], output_ms);
+    if (result->cells_computed > 0 || result->masks > 0) {
+        printf("计数: 计算格子 %lld 个，跳过格子 %lld 个，检查掩码 %lld 个\n",
+               result->cells_computed, result->cells_skipped, result->masks);
+    }
+    if (result->perf_cycles >= 0 || result->perf_instructions >= 0 || result->perf_cache_misses >= 0) {
+        printf("硬件计数（调用线程）: CPU周期 %lld，指令 %lld", result->perf_cycles, result->perf_instructions);
+        if (result->perf_cycles > 0 && result->perf_instructions >= 0) {
+            printf("（IPC %.2f）", (double)result->perf_instructions / result->perf_cycles);
+        }
+        printf("，缓存未命中 %lld\n", result->perf_cache_misses);
+    } else if (console_perf) {
+        printf("硬件计数: perf_event_open 不可用（非Linux、权限不足或虚拟机不支持）\n");
+    }
+    printf("\n");
+    if (run_record_path) {
+        write_run_record(run_record_path, method_name, n, C, result, output_ms);
+    }
+}
+
+/*
+ * 打印结果并写入CSV，执行时间是从 start（wall_time_ms()）算起的墙钟时间：多线程求解时 clock()
+ * 是各线程CPU时间之和，会把并行加速算成变慢；随后由 report_phases 打印分阶段耗时
+ */
+void report_solution(const char* method_name, Item* items, int n, int C, const KnapsackResult* result,
+                     double start, const char* csv_filename) {
+    double output_start = wall_time_ms(), output_ms;
+    double execution_time = output_start - start;
+
+    print_solution(method_name, items, result->selection, n, C, execution_time);
+    if (csv_filename) {
+        write_to_csv(csv_filename, method_name, items, result->selection, n, C, execution_time);
+    }
+    output_ms = wall_time_ms() - output_start;
+    report_phases(method_name, n, C, result, output_ms);
+}
+
+/*
+ * 排序后的物品列（结构数组）：热循环只读取用到的列，重量列为 weight_t。
+ * 排序只移动 64 位键和下标，不搬动整个 Item；重量超过 C 的物品不可能被选中，不进入列中。
+ */
+typedef struct {
+    int n;                  /* 列中的物品数 */
+    int* index;             /* 在原物品数组中的下标 */
+    weight_t* weight;
+    value_t* value;
+    double* density;
+} ItemColumns;
+
+/* 非负价值转换为按无符号整数比较时保持顺序的键（order_key_double 见 knapsack_kernel.h） */
+#if VALUE_IS_INTEGER
+#define order_key_value(v) ((unsigned long long)(v))
+#else
+#define order_key_value(v) order_key_double(v)
+#endif
+
+#define ITEM_ORDER_DENSITY 0    /* 密度降序 */
+#define ITEM_ORDER_WEIGHT 1     /* 重量升序，同重量价值降序（重量分组法） */
+
+/* 第 i 个物品的重量、价值和密度：file 不为 NULL 时直接读映射的物品文件列，否则读 items */
+#define source_weight(items, file, i) ((file) ? (file)->weight[i] : (items)[i].weight)
+#define source_value(items, file, i) ((file) ? (value_t)VALUE_FROM_CENTS((file)->value_cents[i]) : (items)[i].value)
+#define source_density(items, file, i) \
+    ((file) ? (double)source_value(items, file, i) / (file)->weight[i] : (items)[i].density)
+
+/*
+ * 从 items（或映射的物品文件 file，此时 items 不用）中取出重量不超过 C 的物品，按 order 排序后按列存放；
+ * 内存取自 arena。文件中的物品重量不为正、价值为负或超出 VALUE_CENTS_MAX 时返回 KNAPSACK_ERR_INVALID。
+ */
+int item_columns_build(KnapsackArena* arena, const Item* items, const KnapsackItemFile* file, int n, int C,
+                       int order, ItemColumns* cols) {
+    int size = n > 0 ? n : 1;
+    unsigned long long* key = (unsigned long long*)knapsack_arena_alloc(arena, size * sizeof(unsigned long long));
+    unsigned long long* key_tmp = (unsigned long long*)knapsack_arena_alloc(arena, size * sizeof(unsigned long long));
+    int* idx_tmp = (int*)knapsack_arena_alloc(arena, size * sizeof(int));
+    int i, m = 0;
+
+    cols->index = (int*)knapsack_arena_alloc(arena, size * sizeof(int));
+    if (!key || !key_tmp || !idx_tmp || !cols->index) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    for (i = 0; i < n; i++) {
+        int w = source_weight(items, file, i);
+        if (file && (w <= 0 || file->value_cents[i] < 0 || file->value_cents[i] > VALUE_CENTS_MAX)) {
+            return KNAPSACK_ERR_INVALID;
+        }
+        if (w <= C) {
+            if (w > WEIGHT_MAX) {
+                return KNAPSACK_ERR_TOO_LARGE;
+            }
+            cols->index[m] = i;
+            key[m] = order == ITEM_ORDER_DENSITY ? ~order_key_double(source_density(items, file, i))
+                                                 : ~order_key_value(source_value(items, file, i));
+            m++;
+        }
+    }
+    radix_sort_keys(key, cols->index, m, key_tmp, idx_tmp);
+    if (order == ITEM_ORDER_WEIGHT) {
+        /* 已按价值降序，再按重量做一次稳定排序 */
+        for (i = 0; i < m; i++) {
+            key[i] = (unsigned long long)source_weight(items, file, cols->index[i]);
+        }
+        radix_sort_keys(key, cols->index, m, key_tmp, idx_tmp);
+    }
+
+    cols->n = m;
+    cols->weight = (weight_t*)knapsack_arena_alloc(arena, (m > 0 ? m : 1) * sizeof(weight_t));
+    cols->value = (value_t*)knapsack_arena_alloc(arena, (m > 0 ? m : 1) * sizeof(value_t));
+    cols->density = (double*)knapsack_arena_alloc(arena, (m > 0 ? m : 1) * sizeof(double));
+    if (!cols->weight || !cols->value || !cols->density) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    for (i = 0; i < m; i++) {
+        int k = cols->index[i];
+        cols->weight[i] = (weight_t)source_weight(items, file, k);
+        cols->value[i] = source_value(items, file, k);
+        cols->density[i] = source_density(items, file, k);
+    }
+    return KNAPSACK_OK;
+}
+
+/* 列的重量、价值前缀和（长度 n+1） */
+void item_columns_prefix(const ItemColumns* cols, long long* prefix_w, double* prefix_v) {
+    int i;
+    prefix_w[0] = 0;
+    prefix_v[0] = 0.0;
+    for (i = 0; i < cols->n; i++) {
+        prefix_w[i + 1] = prefix_w[i] + cols->weight[i];
+        prefix_v[i + 1] = prefix_v[i] + (double)cols->value[i];
+    }
+}
+
+/* 最低位1的下标（x 不为0） */
+int lowest_set_bit(unsigned long long x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int k = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        k++;
+    }
+    return k;
+#endif
+}
+
+/*
+ * 蛮力法：按格雷码顺序枚举全部 2^n 个子集，相邻子集只差一个物品，
+ * 重量和价值每步只需加或减一次，整个过程不再分配内存。
+ */
+int solve_brute_force(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    value_t max_value = 0;
+    unsigned long long total, i, gray = 0, best_mask = 0;
+    int current_weight = 0;
+    value_t current_value = 0;
+    int j;
+
+    if (n > 62) {
+        return KNAPSACK_ERR_TOO_LARGE;
+    }
+    total = 1ULL << n;
+    result->masks = (long long)total;
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    
+    for (i = 1; i < total; i++) {
+        j = lowest_set_bit(i);
+        gray ^= 1ULL << j;
+        if ((gray >> j) & 1) {
+            current_weight += items[j].weight;
+            current_value += items[j].value;
+        } else {
+            current_weight -= items[j].weight;
+            current_value -= items[j].value;
+        }
+
+        if (current_weight <= C && current_value > max_value) {
+            max_value = current_value;
+            best_mask = gray;
+        }
+        
+        /* 进度（约每100万次报告一次） */
+        if ((i & 0xFFFFF) == 0 && solver->progress) {
+            solver->progress(solver->progress_user, (long long)i, (long long)total);
+        }
+    }
+
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    for (j = 0; j < n; j++) {
+        result->selection[j] = (int)((best_mask >> j) & 1);
+    }
+    return KNAPSACK_OK;
+}
+
+void brute_force_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("蛮力法开始计算（格雷码顺序，将检查 %llu 种组合）...\n", 1ULL << n);
+    if (console_solve("蛮力法", items, n, C, KNAPSACK_ALGO_BRUTE_FORCE, "已处理", &result)) {
+        report_solution("蛮力法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/*
+ * 并行蛮力法的掩码块内核：把低8位物品的 256 种选择看成一块，
+ * 块内各掩码的重量、价值直接查表 lw / lv（按低字节下标），返回满足 lw[k] <= remaining 的最大 lv[k]，
+ * 都不超过 floor_value 时返回 floor_value。重量表与价值表同类型，方便同宽度的向量逐通道比较。
+ */
+typedef value_t (*mask_block_fn)(const value_t* lw, const value_t* lv, value_t remaining, value_t floor_value);
+
+value_t mask_block_scalar(const value_t* lw, const value_t* lv, value_t remaining, value_t floor_value) {
+    value_t best = floor_value;
+    int k;
+    for (k = 0; k < 256; k++) {
+        if (lw[k] <= remaining && lv[k] > best) {
+            best = lv[k];
+        }
+    }
+    return best;
+}
+
+#ifdef KNAPSACK_X86_DISPATCH
+#if defined(KNAPSACK_VALUE_INT32)
+typedef int value_mask_t;
+#else
+typedef long long value_mask_t;
+#endif
+
+/* 用GCC向量扩展写一次，分别以 SSE2/AVX2/AVX-512 编译：每条指令同时检查 BYTES/sizeof(value_t) 个掩码 */
+#define MASK_BLOCK_KERNEL(name, isa, BYTES) \
+__attribute__((target(isa))) \
+value_t name(const value_t* lw, const value_t* lv, value_t remaining, value_t floor_value) { \
+    typedef value_t vv_t __attribute__((vector_size(BYTES))); \
+    typedef value_mask_t vm_t __attribute__((vector_size(BYTES))); \
+    const int lanes = (int)(BYTES / sizeof(value_t)); \
+    vv_t acc, rem; \
+    value_t best = floor_value; \
+    int k; \
+    for (k = 0; k < lanes; k++) { \
+        acc[k] = floor_value; \
+        rem[k] = remaining; \
+    } \
+    for (k = 0; k < 256; k += lanes) { \
+        vv_t w, v; \
+        vm_t ok, gt; \
+        memcpy(&w, lw + k, BYTES); \
+        memcpy(&v, lv + k, BYTES); \
+        ok = (w <= rem); \
+        v = (vv_t)(((vm_t)v & ok) | ((vm_t)acc & ~ok)); \
+        gt = (v > acc); \
+        acc = (vv_t)(((vm_t)v & gt) | ((vm_t)acc & ~gt)); \
+    } \
+    for (k = 0; k < lanes; k++) { \
+        if (acc[k] > best) best = acc[k]; \
+    } \
+    return best; \
+}
+
+MASK_BLOCK_KERNEL(mask_block_sse2, "sse2", 16)
+MASK_BLOCK_KERNEL(mask_block_avx2, "avx2", 32)
+MASK_BLOCK_KERNEL(mask_block_avx512, "avx512f", 64)
+#undef MASK_BLOCK_KERNEL
+#endif /* KNAPSACK_X86_DISPATCH */
+
+mask_block_fn mask_block_best = mask_block_scalar;
+
+/* 根据CPU选择掩码块内核，返回内核名称 */
+const char* mask_block_init(void) {
+#ifdef KNAPSACK_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        mask_block_best = mask_block_avx512;
+        return "AVX-512";
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        mask_block_best = mask_block_avx2;
+        return "AVX2";
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        mask_block_best = mask_block_sse2;
+        return "SSE2";
+    }
+#endif
+    mask_block_best = mask_block_scalar;
+    return "标量";
+}
+
+/*
+ * 并行蛮力法：物品每8个一组预先算出 256 种选择的重量和、价值和（按字节查表）。
+ * 掩码的高位部分在线程间分块，每个高位值对应一块 256 个低位掩码，交给向量内核一起检查；
+ * 各线程保留自己的最优解，最后归约。仍然检查全部 2^n 个组合，可作为其他算法的对照。
+ */
+int solve_parallel_brute_force(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    int num_bytes = (n + 7) / 8;
+    int low_bits = n < 8 ? n : 8;
+    long long blocks;
+    value_t (*lut_w)[256];
+    value_t (*lut_v)[256];
+    value_t best_value = 0;
+    unsigned long long best_mask = 0;
+    long long masks = 0;
+    int b, k, j;
+
+    if (n > 62) {
+        return KNAPSACK_ERR_TOO_LARGE;
+    }
+    blocks = 1LL << (n - low_bits);
+    lut_w = (value_t (*)[256])knapsack_arena_alloc(&solver->arena, (num_bytes > 0 ? num_bytes : 1) * sizeof(*lut_w));
+    lut_v = (value_t (*)[256])knapsack_arena_alloc(&solver->arena, (num_bytes > 0 ? num_bytes : 1) * sizeof(*lut_v));
+    if (!lut_w || !lut_v) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+
+    /* 每个字节的 256 种选择；不存在的物品位对应的表项设为放不下 */
+    for (b = 0; b < num_bytes; b++) {
+        for (k = 0; k < 256; k++) {
+            value_t w = 0, v = 0;
+            int valid = 1;
+            for (j = 0; j < 8; j++) {
+                if ((k >> j) & 1) {
+                    if (b * 8 + j >= n) {
+                        valid = 0;
+                        break;
+                    }
+                    w += items[b * 8 + j].weight;
+                    v += items[b * 8 + j].value;
+                }
+            }
+            lut_w[b][k] = valid ? w : (value_t)C + 1;
+            lut_v[b][k] = valid ? v : 0;
+        }
+    }
+    if (num_bytes == 0) {
+        for (k = 0; k < 256; k++) {
+            lut_w[0][k] = k == 0 ? 0 : (value_t)C + 1;
+            lut_v[0][k] = 0;
+        }
+    }
+
+    #pragma omp parallel num_threads(dp_threads)
+    {
+        value_t t_best = 0;
+        unsigned long long t_mask = 0;
+        long long hi;
+
+        #pragma omp for schedule(dynamic, 64) reduction(+:masks)
+        for (hi = 0; hi < blocks; hi++) {
+            value_t base_w = 0, base_v = 0, block_best;
+            int byte_index;
+            for (byte_index = 1; byte_index < num_bytes; byte_index++) {
+                int sel = (int)((hi >> ((byte_index - 1) * 8)) & 0xFF);
+                base_w += lut_w[byte_index][sel];
+                base_v += lut_v[byte_index][sel];
+            }
+            if (base_w > C) {
+                continue;
+            }
+            masks += 1LL << low_bits;
+            block_best = mask_block_best(lut_w[0], lut_v[0], C - base_w, t_best - base_v);
+            if (block_best + base_v > t_best) {
+                /* 少见：块内有更优的掩码，逐个找出它 */
+                int lo;
+                for (lo = 0; lo < 256; lo++) {
+                    if (lut_w[0][lo] <= C - base_w && base_v + lut_v[0][lo] > t_best) {
+                        t_best = base_v + lut_v[0][lo];
+                        t_mask = ((unsigned long long)hi << low_bits) | (unsigned long long)lo;
+                    }
+                }
+            }
+        }
+
+        #pragma omp critical
+        {
+            if (t_best > best_value || (t_best == best_value && t_mask < best_mask)) {
+                best_value = t_best;
+                best_mask = t_mask;
+            }
+        }
+    }
+    result->masks = masks;
+
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    for (j = 0; j < n; j++) {
+        result->selection[j] = (int)((best_mask >> j) & 1);
+    }
+    return KNAPSACK_OK;
+}
+
+void parallel_brute_force_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("并行蛮力法开始计算（%d 个线程，每块 %d 个掩码，共 %llu 种组合）...\n",
+           dp_threads, 1 << (n < 8 ? n : 8), 1ULL << n);
+    if (console_solve("并行蛮力法", items, n, C, KNAPSACK_ALGO_PARALLEL_BRUTE_FORCE, NULL, &result)) {
+        report_solution("并行蛮力法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/* 折半搜索中一半物品的一个子集 */
+typedef struct {
+    int weight;
+    value_t value;
+    unsigned int mask;      /* 该半边内的物品选择，最多32位 */
+} SubsetSum;
+
+/*
+ * 生成 items[0, count) 的所有子集中不被支配的部分：按重量升序、价值严格递增，且重量不超过 C。
+ * 每加入一个物品，把当前列表与"列表+该物品"按重量归并并去掉被支配的项，
+ * 因此列表始终有序，无需额外排序，长度不超过 min(2^count, C+1)。
+ * buf 和 scratch 至少要有 min(2^count, C+1) 个元素的空间，返回列表长度。
+ */
+int mitm_build_half(const Item* items, int count, int C, SubsetSum* buf, SubsetSum* scratch) {
+    int size = 1, k;
+    buf[0].weight = 0;
+    buf[0].value = 0;
+    buf[0].mask = 0;
+
+    for (k = 0; k < count; k++) {
+        int wt = items[k].weight;
+        value_t v = items[k].value;
+        int a = 0, b = 0, out = 0;
+        SubsetSum* t;
+
+        while (a < size || b < size) {
+            SubsetSum cand;
+            int take_a;
+            if (b >= size || buf[b].weight + wt > C) {
+                if (a >= size) break;
+                take_a = 1;
+            } else if (a >= size) {
+                take_a = 0;
+            } else {
+                take_a = buf[a].weight <= buf[b].weight + wt;
+            }
+            if (take_a) {
+                cand = buf[a++];
+            } else {
+                cand.weight = buf[b].weight + wt;
+                cand.value = buf[b].value + v;
+                cand.mask = buf[b].mask | (1u << k);
+                b++;
+            }
+            /* 相同重量保留价值大的；价值不超过前一项的被支配 */
+            if (out > 0 && scratch[out - 1].weight == cand.weight) {
+                if (cand.value > scratch[out - 1].value) {
+                    scratch[out - 1] = cand;
+                }
+                continue;
+            }
+            if (out > 0 && cand.value <= scratch[out - 1].value) {
+                continue;
+            }
+            scratch[out++] = cand;
+        }
+
+        t = buf;
+        buf = scratch;
+        scratch = t;
+        size = out;
+    }
+
+    /* 交换了奇数次时结果在调用方的 scratch 里，拷回调用方的 buf */
+    if (count % 2 == 1) {
+        memcpy(scratch, buf, size * sizeof(SubsetSum));
+    }
+    return size;
+}
+
+/*
+ * 折半搜索法（Horowitz–Sahni）：两半各自生成有序且去掉被支配项的子集列表，
+ * 再用双指针一次扫描找出重量和不超过 C 的最大价值组合。结果与蛮力法一样是精确解。
+ */
+int solve_meet_in_middle(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    int n1 = n / 2;
+    int n2 = n - n1;
+    long long cap1, cap2;
+    SubsetSum *left, *right, *scratch;
+    int size1, size2, i, j, best_i = 0, best_j = 0;
+    value_t best = -1;
+
+    if (n2 > 32) {
+        return KNAPSACK_ERR_TOO_LARGE;      /* 每半的选择用32位掩码记录 */
+    }
+    cap1 = (1LL << n1) < (long long)C + 1 ? (1LL << n1) : (long long)C + 1;
+    cap2 = (1LL << n2) < (long long)C + 1 ? (1LL << n2) : (long long)C + 1;
+    left = (SubsetSum*)knapsack_arena_alloc(&solver->arena, cap1 * sizeof(SubsetSum));
+    right = (SubsetSum*)knapsack_arena_alloc(&solver->arena, cap2 * sizeof(SubsetSum));
+    scratch = (SubsetSum*)knapsack_arena_alloc(&solver->arena, (cap1 > cap2 ? cap1 : cap2) * sizeof(SubsetSum));
+    if (!left || !right || !scratch) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+
+    size1 = mitm_build_half(items, n1, C, left, scratch);
+    size2 = mitm_build_half(items + n1, n2, C, right, scratch);
+    result->subsets_left = size1;
+    result->subsets_right = size2;
+
+    /* 前半按重量升序扫描，后半的指针随之从大到小移动 */
+    j = size2 - 1;
+    for (i = 0; i < size1; i++) {
+        while (j >= 0 && left[i].weight + right[j].weight > C) {
+            j--;
+        }
+        if (j < 0) {
+            break;
+        }
+        if (left[i].value + right[j].value > best) {
+            best = left[i].value + right[j].value;
+            best_i = i;
+            best_j = j;
+        }
+    }
+
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    for (i = 0; i < n1; i++) {
+        result->selection[i] = (int)((left[best_i].mask >> i) & 1);
+    }
+    for (i = 0; i < n2; i++) {
+        result->selection[n1 + i] = (int)((right[best_j].mask >> i) & 1);
+    }
+    return KNAPSACK_OK;
+}
+
+void meet_in_middle_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("折半搜索法开始计算（两半各 %d / %d 个物品）...\n", n / 2, n - n / 2);
+    if (console_solve("折半搜索法", items, n, C, KNAPSACK_ALGO_MEET_IN_MIDDLE, NULL, &result)) {
+        printf("不被支配的子集: 前半 %d 个，后半 %d 个\n", result.subsets_left, result.subsets_right);
+        report_solution("折半搜索法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/* 分块填表时传给 dp_tile_fill 的上下文 */
+typedef struct {
+    const Item* items;
+    value_t** dp;
+    unsigned char** keep;
+    int n;
+    int C;
+    KnapsackSolver* solver;
+} DpTileContext;
+
+/* 每填完约十分之一的行报告一次进度 */
+void dp_report_row(KnapsackSolver* solver, int row, int n) {
+    if (solver->progress && (n < 10 || row % (n / 10) == 0 || row == n)) {
+        solver->progress(solver->progress_user, row, n);
+    }
+}
+
+/* 计算第 item+1 行的 [lo, hi] 段；一行的最后一段算完时报告进度 */
+void dp_tile_fill(void* ctx, int item, int lo, int hi) {
+    DpTileContext* tile = (DpTileContext*)ctx;
+    int row = item + 1;
+    dp_row_kernel(tile->dp[item], tile->dp[row], tile->keep[row], lo, hi,
+                  tile->items[item].weight, tile->items[item].value);
+    if (hi == tile->C) {
+        dp_report_row(tile->solver, row, tile->n);
+    }
+}
+
+/* 动态规划法 */
+int solve_dynamic_programming(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    value_t** dp = (value_t**)knapsack_arena_alloc(&solver->arena, (n + 1) * sizeof(value_t*));  /* 各行由负责对应容量段的线程首次写入 */
+    unsigned char** keep = (unsigned char**)knapsack_arena_alloc(&solver->arena, (n + 1) * sizeof(unsigned char*));  /* 选取标记按位打包 */
+    int i, current_cap, tile_items, tile_width;
+    
+    solver_phase(solver, result, KNAPSACK_PHASE_ALLOC);
+    if (!dp || !keep) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+
+    for (i = 0; i <= n; i++) {
+        dp[i] = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+        keep[i] = (unsigned char*)knapsack_arena_alloc(&solver->arena, DP_KEEP_BYTES(C));
+        if (!dp[i] || !keep[i]) {
+            return KNAPSACK_ERR_NOMEM;
+        }
+    }
+    
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    result->cells_computed = (long long)n * (C + 1);
+    tile_items = dp_tile_plan(C, sizeof(value_t), &tile_width);
+    if (tile_items > 1) {
+        /* 分块填表：每次处理 tile_items 个物品 × tile_width 个容量单元 */
+        DpTileContext tile;
+        tile.items = items;
+        tile.dp = dp;
+        tile.keep = keep;
+        tile.n = n;
+        tile.C = C;
+        tile.solver = solver;
+        memset(dp[0], 0, (C + 1) * sizeof(value_t));
+        memset(keep[0], 0, DP_KEEP_BYTES(C));
+        dp_tile_schedule(n, C, tile_items, tile_width, dp_tile_fill, &tile);
+    } else {
+        /* 填充DP表：按容量维度分段，每个线程负责一段，每个物品之后同步一次 */
+        #pragma omp parallel num_threads(dp_thread_count(C))
+        {
+            int row, lo, hi, k;
+            dp_thread_slice(C, &lo, &hi);
+            for (k = lo; k <= hi; k++) {
+                dp[0][k] = 0;
+            }
+            memset(keep[0] + (lo >> 3), 0, (hi >> 3) - (lo >> 3) + 1);
+            #pragma omp barrier
+            
+            for (row = 1; row <= n; row++) {
+                dp_row_kernel(dp[row-1], dp[row], keep[row], lo, hi, items[row-1].weight, items[row-1].value);
+                #pragma omp barrier
+                
+                #pragma omp master
+                dp_report_row(solver, row, n);
+            }
+        }
+    }
+
+    /* 重构解 */
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    current_cap = C;
+    for (i = n; i > 0; i--) {
+        if (DP_KEEP_GET(keep[i], current_cap)) {
+            result->selection[i-1] = 1;
+            current_cap -= items[i-1].weight;
+        }
+    }
+    return KNAPSACK_OK;
+}
+
+void dynamic_programming_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+    int tile_items, tile_width;
+    
+    printf("动态规划法开始计算（创建 %d x %d 的DP表）...\n", n+1, C+1);
+    tile_items = dp_tile_plan(C, sizeof(value_t), &tile_width);
+    if (tile_items > 1) {
+        printf("DP分块: 每块 %d 个物品 × %d 个容量单元（%d × %d 块），工作集约 %.0f KB，L2 %.0f KB\n",
+               tile_items, tile_width, (n + tile_items - 1) / tile_items, C / tile_width + 1,
+               (tile_items + 1.0) * tile_width * sizeof(value_t) / 1024.0, dp_l2_bytes() / 1024.0);
+    }
+    if (console_solve("动态规划法", items, n, C, KNAPSACK_ALGO_DP, "DP表填充进度", &result)) {
+        if (result.capacity_bound < C) {
+            printf("位集预处理: 最大可达重量 %d，DP表收紧为 %d x %d\n", result.capacity_bound, n+1, result.capacity_bound+1);
+        }
+        report_solution("动态规划法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/*
+ * 线性空间动态规划辅助函数：对 items[lo, hi) 做一维DP，row[w] 为容量不超过 w 时的最大价值。
+ * 单线程时原地更新；多线程时在 row 和 tmp 之间交替，保证最终结果落在 row 中。
+ */
+void dp_fill_row(const Item* items, int lo, int hi, int C, value_t* row, value_t* tmp) {
+    int i, w;
+    int threads = dp_thread_count(C);
+
+    if (threads == 1 || !tmp) {
+        for (w = 0; w <= C; w++) {
+            row[w] = 0;
+        }
+        for (i = lo; i < hi; i++) {
+            dp_row_update(row, row, NULL, C, items[i].weight, items[i].value);
+        }
+        return;
+    }
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int k, s_lo, s_hi;
+        value_t* src = ((hi - lo) % 2 == 0) ? row : tmp;
+        value_t* dst = (src == row) ? tmp : row;
+        value_t* t;
+
+        dp_thread_slice(C, &s_lo, &s_hi);
+        for (k = s_lo; k <= s_hi; k++) {
+            src[k] = 0;
+        }
+        #pragma omp barrier
+
+        for (k = lo; k < hi; k++) {
+            dp_row_kernel(src, dst, NULL, s_lo, s_hi, items[k].weight, items[k].value);
+            #pragma omp barrier
+            t = src;
+            src = dst;
+            dst = t;
+        }
+    }
+}
+
+/* Hirschberg式分治：把物品区间对半分，用两条DP行找到容量的最优划分点，再分别递归 */
+void hirschberg_recursive(const Item* items, int lo, int hi, int C, value_t* f, value_t* g, value_t* tmp, int* selection,
+                          long long* cells) {
+    int mid, c, best_c;
+    value_t best;
+
+    if (lo >= hi || C <= 0) {
+        return;
+    }
+    if (hi - lo == 1) {
+        if (items[lo].weight <= C) {
+            selection[lo] = 1;
+        }
+        return;
+    }
+
+    mid = lo + (hi - lo) / 2;
+    dp_fill_row(items, lo, mid, C, f, tmp);
+    dp_fill_row(items, mid, hi, C, g, tmp);
+    *cells += (long long)(hi - lo) * (C + 1);
+
+    best = -1;
+    best_c = 0;
+    for (c = 0; c <= C; c++) {
+        if (f[c] + g[C - c] > best) {
+            best = f[c] + g[C - c];
+            best_c = c;
+        }
+    }
+
+    /* f、g 的内容已用完，子问题可以复用这两条行 */
+    hirschberg_recursive(items, lo, mid, best_c, f, g, tmp, selection, cells);
+    hirschberg_recursive(items, mid, hi, C - best_c, f, g, tmp, selection, cells);
+}
+
+/* 线性空间动态规划法：只保留 O(C) 的DP行，通过分治递归重构选中的物品 */
+int solve_linear_space_dp(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    value_t* f = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+    value_t* g = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+    value_t* tmp = NULL;  /* 多线程填表时的交替行 */
+
+    if (dp_thread_count(C) > 1) {
+        tmp = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+    }
+    if (!f || !g) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+
+    /* 顶层两次填行得到最优值，之后的递归都是在重构选择，填表和重构交织在一起，一并计入填表 */
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    hirschberg_recursive(items, 0, n, C, f, g, tmp, result->selection, &result->cells_computed);
+    return KNAPSACK_OK;
+}
+
+void linear_space_dp_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("线性空间动态规划法开始计算（仅使用 2 x %d 的DP行，约 %.1f MB）...\n",
+           C + 1, 2.0 * (C + 1) * sizeof(value_t) / (1024.0 * 1024.0));
+    if (console_solve("线性空间动态规划法", items, n, C, KNAPSACK_ALGO_LINEAR_DP, NULL, &result)) {
+        if (result.capacity_bound < C) {
+            printf("位集预处理: 最大可达重量 %d，DP行收紧为 %d 个单元\n", result.capacity_bound, result.capacity_bound+1);
+        }
+        report_solution("线性空间动态规划法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/* 重量分组法：同一重量的物品构成一个分组，组内价值降序后只可能选取前 k 件 */
+typedef struct {
+    int weight;
+    int start;                  /* 在排序后数组中的起始下标 */
+    int count;
+    int kmax;                   /* 最多可选件数 min(count, C / weight) */
+    value_t* prefix;            /* prefix[k] 为组内前 k 件的价值和 */
+    unsigned short* choice16;   /* 每个容量下选取的件数，所有分组的 kmax <= 65535 时使用 */
+    int* choice32;              /* 否则使用 int */
+} WeightClass;
+
+/*
+ * 对同一余数 r 的容量序列做一次 max-plus 卷积时用到的上下文。
+ * 整行先按余数转置，余数 r 的序列 row[r], row[r+w], ... 连续存放在 seq 中，最优列记在 best 中；
+ * 卷积结束后 seq 原地改成新的DP值，best 改成选取的件数，再一次转置写回。
+ */
+typedef struct {
+    WeightClass* wc;
+    value_t* seq;
+    int* best;
+} WeightClassPass;
+
+/*
+ * 卷积矩阵 A[j][i] = seq[i] + prefix[j - i]（j - kmax <= i <= j）在行 j 上 A[j][a] < A[j][b] 时返回非0。
+ * 窗口外的项看成 prefix 两端按"无穷大"斜率线性延伸：先比离窗口的距离（越近越大），距离相同时
+ * 按最近的窗口边界取 prefix 再比数值。延伸后的 prefix 仍是凹的，矩阵保持完全单调，窗口内的列总是胜过窗口外的列。
+ */
+int weight_class_less(const WeightClassPass* pass, int j, int a, int b) {
+    int kmax = pass->wc->kmax;
+    int ta = j - a, tb = j - b;
+    int ga = ta < 0 ? -ta : (ta > kmax ? ta - kmax : 0);
+    int gb = tb < 0 ? -tb : (tb > kmax ? tb - kmax : 0);
+    if (ga != gb) {
+        return ga > gb;
+    }
+    if (ta < 0) ta = 0;
+    if (ta > kmax) ta = kmax;
+    if (tb < 0) tb = 0;
+    if (tb > kmax) tb = kmax;
+    return pass->seq[a] + pass->wc->prefix[ta] < pass->seq[b] + pass->wc->prefix[tb];
+}
+
+/*
+ * SMAWK：求行 row0, row0+step, ...（共 rows 行）的最优列（相同时取最左）写入 best，候选列为 cols[0..ncols)，
+ * cols 为 NULL 时是 0..ncols-1。先删去对这些行都不可能最优的列（剩下不超过 rows 列），递归求奇数行，
+ * 偶数行的最优列夹在相邻两个奇数行的最优列之间，顺序扫一遍即可。工作量 O(rows + ncols)，
+ * scratch 至少 ncols + rows 个 int。
+ */
+void weight_class_smawk(WeightClassPass* pass, int row0, int step, int rows, const int* cols, int ncols, int* scratch) {
+    int* kept = scratch;
+    int k = 0, c, t, pos = 0;
+
+    if (rows == 0) {
+        return;
+    }
+    for (c = 0; c < ncols; c++) {
+        int col = cols ? cols[c] : c;
+        while (k > 0 && weight_class_less(pass, row0 + (k - 1) * step, kept[k - 1], col)) {
+            k--;
+        }
+        if (k < rows) {
+            kept[k++] = col;
+        }
+    }
+    weight_class_smawk(pass, row0 + step, step * 2, rows / 2, kept, k, scratch + k);
+
+    for (t = 0; t < rows; t += 2) {
+        int j = row0 + t * step;
+        int last = t + 1 < rows ? pass->best[j + step] : kept[k - 1];
+        int b = kept[pos];
+        while (kept[pos] != last) {
+            pos++;
+            if (weight_class_less(pass, j, b, kept[pos])) {
+                b = kept[pos];
+            }
+        }
+        pass->best[j] = b;
+    }
+}
+
+/* 余数 r 的一条序列：共 m+1 项，m = (C-r)/w；卷积后 seq[j] 为新的DP值，best[j] 为选取的件数 */
+void weight_class_convolve(WeightClassPass* pass, int m, int* scratch) {
+    WeightClass* wc = pass->wc;
+    int j;
+
+    weight_class_smawk(pass, 0, 1, m + 1, NULL, m + 1, scratch);
+    /* 最优列 best[j] <= j，从后往前写不会覆盖还要读的项 */
+    for (j = m; j >= 0; j--) {
+        int i = pass->best[j];
+        pass->seq[j] = pass->seq[i] + wc->prefix[j - i];
+        pass->best[j] = j - i;
+    }
+}
+
+/* 每个线程的 SMAWK 工作区（按 int 计）：递归各层保留的列合计不超过 2(C/w+1) 再加上层数 */
+#define WEIGHT_CLASS_SCRATCH(C, w) (2 * ((C) / (w) + 1) + 64)
+
+/* 转置时每块的行数：一块覆盖 row 中 64×w 个连续容量，重量在1-100时不到 64 KB */
+#define WEIGHT_CLASS_BLOCK 64
+
+/*
+ * 依次合并第 [from, to) 组，row 原地更新，各组选取的件数写入其 choice 表。
+ * 按余数逐条卷积时直接跨步读写 row，行大于缓存后每条余数都要把整行过一遍；所以每组先把 row 按余数
+ * 转置到 work（余数 r 的序列从 r*q + min(r, rem) 开始，q、rem 为 (C+1) 除以 w 的商和余数），
+ * 卷积在连续内存上做，再顺序转置回 row 和 choice。余数之间相互独立，分给多个线程。
+ * work 为 C+1 个 value_t，scratch 共 3(C+1)+66×dp_threads 个 int 就够用。
+ */
+void weight_class_merge(WeightClass* classes, int from, int to, int C, value_t* row, value_t* work, int* scratch) {
+    int* take = scratch;
+    int* smawk = scratch + (C + 1);
+    int i;
+    for (i = from; i < to; i++) {
+        WeightClass* wc = &classes[i];
+        int w = wc->weight;
+        int residues = w <= C ? w : C + 1;
+        int q = (C + 1) / w, rem = (C + 1) % w;
+        int threads = residues < dp_threads ? residues : dp_threads;
+        int slice = WEIGHT_CLASS_SCRATCH(C, w);
+        int j, r;
+
+        /* 按 WEIGHT_CLASS_BLOCK 行一块转置，一块跨的 row 区间留在缓存里，每条余数的写入是连续的 */
+        #pragma omp parallel for schedule(static) num_threads(dp_threads)
+        for (j = 0; j <= q; j += WEIGHT_CLASS_BLOCK) {
+            int t;
+            for (t = 0; t < residues; t++) {
+                int len = t < rem ? q + 1 : q;
+                int end = j + WEIGHT_CLASS_BLOCK < len ? j + WEIGHT_CLASS_BLOCK : len;
+                value_t* dst = work + t * q + (t < rem ? t : rem);
+                int u;
+                for (u = j; u < end; u++) {
+                    dst[u] = row[t + u * w];
+                }
+            }
+        }
+        #pragma omp parallel for schedule(dynamic) num_threads(threads)
+        for (r = 0; r < residues; r++) {
+            WeightClassPass pass;
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            int off = r * q + (r < rem ? r : rem);
+            pass.wc = wc;
+            pass.seq = work + off;
+            pass.best = take + off;
+            weight_class_convolve(&pass, (C - r) / w, smawk + (size_t)tid * slice);
+        }
+        #pragma omp parallel for schedule(static) num_threads(dp_threads)
+        for (j = 0; j <= q; j += WEIGHT_CLASS_BLOCK) {
+            int t;
+            for (t = 0; t < residues; t++) {
+                int len = t < rem ? q + 1 : q;
+                int end = j + WEIGHT_CLASS_BLOCK < len ? j + WEIGHT_CLASS_BLOCK : len;
+                int off = t * q + (t < rem ? t : rem);
+                int u;
+                for (u = j; u < end; u++) {
+                    row[t + u * w] = work[off + u];
+                }
+                if (wc->choice16) {
+                    for (u = j; u < end; u++) {
+                        wc->choice16[t + u * w] = (unsigned short)take[off + u];
+                    }
+                } else {
+                    for (u = j; u < end; u++) {
+                        wc->choice32[t + u * w] = take[off + u];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* 所有分组的选择表合计不超过这个字节数时全部保存，不分段重算 */
+#define WEIGHT_CLASS_CHOICE_BUDGET (64 << 20)
+
+/*
+ * 每段的分组数：选择表放得下时为分组数（只有一段）；否则检查点行（value_t）和一段的选择表（elem 字节）
+ * 合计最少时约为 sqrt(分组数 × sizeof(value_t) / elem)，预算还容得下更多张选择表时按预算取，段数越少重算越少。
+ */
+int weight_class_segment(int num_classes, int C, size_t elem) {
+    int seg, fit, segments;
+    if ((double)num_classes * (C + 1.0) * elem <= WEIGHT_CLASS_CHOICE_BUDGET) {
+        return num_classes > 0 ? num_classes : 1;
+    }
+    seg = (int)ceil(sqrt((double)num_classes * sizeof(value_t) / elem));
+    fit = (int)(WEIGHT_CLASS_CHOICE_BUDGET / ((C + 1.0) * elem));
+    if (seg < fit) seg = fit;
+    if (seg > num_classes) seg = num_classes;
+    /* 段数不变时把分组平均分到各段：最后一段不用重算，不让它只剩几组 */
+    segments = (num_classes + seg - 1) / seg;
+    return (num_classes + segments - 1) / segments;
+}
+
+/*
+ * 重量分组法：每组一次凹序列 max-plus 卷积，用 SMAWK 做到 O(C)，总共 O(分组数 × C)，物品重量只有1-100时与N无关。
+ * 选择表超出 WEIGHT_CLASS_CHOICE_BUDGET 时不为每组各存一张：分组按 seg 个一段，只保存每段开头的DP行（检查点）
+ * 和一段的选择表，回溯到某一段时从它的检查点重算这一段，填表工作量至多翻倍，内存从 分组数 张选择表降到约 2×sqrt(分组数) 行。
+ */
+int solve_weight_class(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    ItemColumns cols;
+    WeightClass* classes = (WeightClass*)knapsack_arena_calloc(&solver->arena, n > 0 ? n : 1, sizeof(WeightClass));
+    value_t* row = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+    value_t* work = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+    int* scratch = (int*)knapsack_arena_alloc(&solver->arena, (3 * ((size_t)C + 1) + 66 * (size_t)dp_threads) * sizeof(int));
+    value_t** checkpoint;
+    void* choice;
+    size_t elem = sizeof(unsigned short);
+    int num_classes = 0, seg, segments;
+    int i, k, w, s, status;
+
+    if (!classes || !row || !work || !scratch) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_SORT);
+    status = item_columns_build(&solver->arena, items, solver->file, n, C, ITEM_ORDER_WEIGHT, &cols);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+
+    /* 划分分组并计算组内价值前缀和 */
+    for (i = 0; i < cols.n; i = k) {
+        WeightClass* wc;
+        k = i;
+        while (k < cols.n && cols.weight[k] == cols.weight[i]) {
+            k++;
+        }
+        wc = &classes[num_classes++];
+        wc->weight = cols.weight[i];
+        wc->start = i;
+        wc->count = k - i;
+        wc->kmax = wc->count < C / wc->weight ? wc->count : C / wc->weight;
+        wc->prefix = (value_t*)knapsack_arena_alloc(&solver->arena, (wc->kmax + 1) * sizeof(value_t));
+        if (!wc->prefix) {
+            return KNAPSACK_ERR_NOMEM;
+        }
+        if (wc->kmax > 65535) {
+            elem = sizeof(int);
+        }
+        wc->prefix[0] = 0;
+        for (w = 1; w <= wc->kmax; w++) {
+            wc->prefix[w] = wc->prefix[w - 1] + cols.value[i + w - 1];
+        }
+    }
+    result->classes = num_classes;
+
+    /* 一段的选择表轮流给各段使用；第0段的检查点是全0行，不保存 */
+    seg = weight_class_segment(num_classes, C, elem);
+    segments = (num_classes + seg - 1) / seg;
+    result->class_segment = seg;
+    choice = knapsack_arena_alloc(&solver->arena, (size_t)seg * (C + 1) * elem);
+    checkpoint = (value_t**)knapsack_arena_calloc(&solver->arena, segments > 0 ? segments : 1, sizeof(value_t*));
+    if (!choice || !checkpoint) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    for (s = 1; s < segments; s++) {
+        checkpoint[s] = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+        if (!checkpoint[s]) {
+            return KNAPSACK_ERR_NOMEM;
+        }
+    }
+    for (i = 0; i < num_classes; i++) {
+        char* slot = (char*)choice + (size_t)(i % seg) * (C + 1) * elem;
+        if (elem == sizeof(unsigned short)) {
+            classes[i].choice16 = (unsigned short*)slot;
+        } else {
+            classes[i].choice32 = (int*)slot;
+        }
+    }
+
+    for (w = 0; w <= C; w++) {
+        row[w] = 0;
+    }
+    for (s = 0; s < segments; s++) {
+        int to = (s + 1) * seg < num_classes ? (s + 1) * seg : num_classes;
+        if (s > 0) {
+            memcpy(checkpoint[s], row, (C + 1) * sizeof(value_t));
+        }
+        weight_class_merge(classes, s * seg, to, C, row, work, scratch);
+    }
+
+    /* 从最后一组往前回溯每组选取的件数；最后一段的选择表还在，之前的段从检查点重算 */
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    {
+        int cap = C;
+        for (s = segments - 1; s >= 0; s--) {
+            int from = s * seg;
+            int to = (s + 1) * seg < num_classes ? (s + 1) * seg : num_classes;
+            if (s < segments - 1) {
+                if (s > 0) {
+                    memcpy(row, checkpoint[s], (C + 1) * sizeof(value_t));
+                } else {
+                    for (w = 0; w <= C; w++) {
+                        row[w] = 0;
+                    }
+                }
+                weight_class_merge(classes, from, to, C, row, work, scratch);
+            }
+            for (i = to - 1; i >= from; i--) {
+                WeightClass* wc = &classes[i];
+                int take = wc->choice16 ? wc->choice16[cap] : wc->choice32[cap];
+                for (k = 0; k < take; k++) {
+                    result->selection[cols.index[wc->start + k]] = 1;
+                }
+                cap -= take * wc->weight;
+            }
+        }
+    }
+
+    return KNAPSACK_OK;
+}
+
+void weight_class_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("重量分组法开始计算（按重量分组，组间做凹序列 max-plus 卷积）...\n");
+    if (console_solve("重量分组法", items, n, C, KNAPSACK_ALGO_WEIGHT_CLASS, NULL, &result)) {
+        int segments = result.class_segment > 0 ? (result.classes + result.class_segment - 1) / result.class_segment : 0;
+        printf("共 %d 个重量分组，每段 %d 组：选择表和检查点约 %.1f MB（每组一张选择表需 %.1f MB）\n",
+               result.classes, result.class_segment,
+               ((double)result.class_segment * sizeof(unsigned short) + (segments > 1 ? segments - 1 : 0) * sizeof(value_t))
+               * (C + 1) / (1024.0 * 1024.0),
+               (double)result.classes * (C + 1) * sizeof(unsigned short) / (1024.0 * 1024.0));
+        report_solution("重量分组法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/*
+ * 分数背包上界：sorted 按密度降序，prefix_w / prefix_v 为其重量、价值前缀和（长度 n+1）。
+ * 返回物品 [from, n) 在容量 cap 下线性松弛的最优值，二分查找断点物品，O(log n)。
+ */
+double fractional_bound(const double* density, const long long* prefix_w, const double* prefix_v, int n, int from, long long cap) {
+    long long limit = prefix_w[from] + cap;
+    int lo = from, hi = n;
+
+    if (cap <= 0) {
+        return 0.0;
+    }
+    /* 找到最大的 k 使 prefix_w[k] <= limit */
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (prefix_w[mid] <= limit) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (lo < n) {
+        return prefix_v[lo] - prefix_v[from] + (double)(limit - prefix_w[lo]) * density[lo];
+    }
+    return prefix_v[n] - prefix_v[from];
+}
+
+/*
+ * 核心法（Pisinger式扩展核）：按密度排序后，断点物品之前的物品固定装入、之后的固定不装，
+ * 只对断点附近的"核心"物品做DP。对核心外每个物品，用"翻转其取值后的分数上界"检验，
+ * 若上界都不超过当前解则当前解即为最优；否则把核心扩大一倍重新求解。
+ */
+int solve_core(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    ItemColumns cols;
+    long long* prefix_w = (long long*)knapsack_arena_alloc(&solver->arena, (n + 1) * sizeof(long long));
+    double* prefix_v = (double*)knapsack_arena_alloc(&solver->arena, (n + 1) * sizeof(double));
+    int* selection = result->selection;
+    int i, break_item, half, rounds = 0, status;
+    int core_start = 0, core_end = 0;
+    value_t best_value = 0;
+
+    if (!prefix_w || !prefix_v) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_SORT);
+    status = item_columns_build(&solver->arena, items, solver->file, n, C, ITEM_ORDER_DENSITY, &cols);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    item_columns_prefix(&cols, prefix_w, prefix_v);
+    n = cols.n;     /* 以下只处理列中的物品，选择也只会落在这些物品上 */
+    for (break_item = 0; break_item < n && prefix_w[break_item + 1] <= C; break_item++);
+
+    for (half = 16; ; half *= 2) {
+        int residual, core_size, unproven = 0;
+        value_t fixed_value = 0;
+        value_t* row;
+        unsigned char* keep;
+
+        rounds++;
+        core_start = break_item - half > 0 ? break_item - half : 0;
+        core_end = break_item + half < n ? break_item + half : n;
+        core_size = core_end - core_start;
+        residual = (int)(C - prefix_w[core_start]);
+        for (i = 0; i < core_start; i++) {
+            fixed_value += cols.value[i];
+        }
+
+        /* 核心内做0-1背包DP，keep 按位记录选择；每轮的核心翻倍，各轮内存合计不超过最后一轮的两倍 */
+        row = (value_t*)knapsack_arena_calloc(&solver->arena, residual + 1, sizeof(value_t));
+        keep = (unsigned char*)knapsack_arena_alloc(&solver->arena, (size_t)(core_size > 0 ? core_size : 1) * DP_KEEP_BYTES(residual));
+        if (!row || !keep) {
+            return KNAPSACK_ERR_NOMEM;
+        }
+        for (i = 0; i < core_size; i++) {
+            dp_row_update(row, row, keep + (size_t)i * DP_KEEP_BYTES(residual), residual,
+                          cols.weight[core_start + i], cols.value[core_start + i]);
+        }
+        best_value = fixed_value + row[residual];
+
+        for (i = 0; i < n; i++) {
+            selection[cols.index[i]] = i < core_start;
+        }
+        {
+            int cap = residual;
+            for (i = core_size - 1; i >= 0; i--) {
+                if (DP_KEEP_GET(keep + (size_t)i * DP_KEEP_BYTES(residual), cap)) {
+                    selection[cols.index[core_start + i]] = 1;
+                    cap -= cols.weight[core_start + i];
+                }
+            }
+        }
+
+        /* 检验核心外的物品：翻转其固定取值后的上界都不超过当前解，则当前解最优 */
+        for (i = 0; i < core_start && !unproven; i++) {
+            double ub = fractional_bound(cols.density, prefix_w, prefix_v, n, 0, C + cols.weight[i])
+                        - (double)cols.value[i];
+            if (!BOUND_CANNOT_IMPROVE(ub, best_value)) unproven++;
+        }
+        for (i = core_end; i < n && !unproven; i++) {
+            double ub = (double)cols.value[i]
+                        + fractional_bound(cols.density, prefix_w, prefix_v, n, 0, C - cols.weight[i]);
+            if (!BOUND_CANNOT_IMPROVE(ub, best_value)) unproven++;
+        }
+
+        if (!unproven || core_size == n) {
+            break;
+        }
+    }
+
+    result->break_item = break_item;
+    result->core_start = core_start;
+    result->core_end = core_end;
+    result->rounds = rounds;
+    return KNAPSACK_OK;
+}
+
+void core_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("核心法开始计算（从贪心断点物品向两侧扩展核心）...\n");
+    if (console_solve("核心法", items, n, C, KNAPSACK_ALGO_CORE, NULL, &result)) {
+        printf("核心法: 断点物品位置 %d，最终核心 [%d, %d) 共 %d 个物品，扩展 %d 轮\n",
+               result.break_item, result.core_start, result.core_end, result.core_end - result.core_start, result.rounds);
+        report_solution("核心法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/* 剪枝DP中处理完前 i 个物品后容量 c 处状态的上界：前 i 个物品装入容量 c 加其余物品装入 C-c，各取分数上界 */
+double pruned_dp_bound(const ItemColumns* cols, const long long* prefix_w, const double* prefix_v, int i, int c, int C) {
+    return fractional_bound(cols->density, prefix_w, prefix_v, i, 0, c)
+         + fractional_bound(cols->density, prefix_w, prefix_v, cols->n, i, C - c);
+}
+
+/*
+ * 剪枝DP窗口的一端：从 from 走向 peak 时上界单调不减且在 peak 处能超过下界，
+ * 找离 from 最近的能超过下界的容量。相邻行的窗口端点相差不大，从上一行的端点 hint 倍增试探再二分。
+ */
+int pruned_dp_edge(const ItemColumns* cols, const long long* prefix_w, const double* prefix_v,
+                   int i, int C, value_t best, int from, int peak, int hint) {
+    int d = peak >= from ? 1 : -1;
+    int lo = -1, hi = (peak - from) * d, step = 1, t;
+
+    /* 以离 from 的距离 t 表示位置：t <= lo 的都不能超过下界，t >= hi 的都能 */
+    t = (hint - from) * d;
+    if (t < 0) t = 0;
+    if (t > hi) t = hi;
+#define PRUNED_DP_BEATS(t) \
+    (!BOUND_CANNOT_IMPROVE(pruned_dp_bound(cols, prefix_w, prefix_v, i, from + d * (t), C), best))
+    if (PRUNED_DP_BEATS(t)) {
+        hi = t;
+        while (hi - step > lo) {
+            if (!PRUNED_DP_BEATS(hi - step)) {
+                lo = hi - step;
+                break;
+            }
+            hi -= step;
+            step *= 2;
+        }
+    } else {
+        lo = t;
+        while (lo + step < hi) {
+            if (PRUNED_DP_BEATS(lo + step)) {
+                hi = lo + step;
+                break;
+            }
+            lo += step;
+            step *= 2;
+        }
+    }
+    while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        if (PRUNED_DP_BEATS(mid)) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+#undef PRUNED_DP_BEATS
+    return from + d * hi;
+}
+
+/*
+ * 剪枝DP第 i 行算完后的上界：窗口 [lo, hi] 内各状态的 row[c] 加其余物品装入 C-c 的分数上界，取最大。
+ * 窗口外的状态已证明无法超过下界。c 递增时剩余容量递减，分数上界的断点物品只往前移，总计 O(窗口宽度 + 移动次数)。
+ */
+double pruned_dp_row_bound(const ItemColumns* cols, const long long* prefix_w, const double* prefix_v,
+                           const value_t* row, int i, int lo, int hi, int C) {
+    long long limit = prefix_w[i] + (C - lo);
+    int j = i, k = cols->n, c;
+    double best = 0.0;
+
+    /* 最大的 j 使 prefix_w[j] <= limit */
+    while (j < k) {
+        int mid = j + (k - j + 1) / 2;
+        if (prefix_w[mid] <= limit) {
+            j = mid;
+        } else {
+            k = mid - 1;
+        }
+    }
+    for (c = lo; c <= hi; c++) {
+        double ub;
+        limit = prefix_w[i] + (C - c);
+        while (prefix_w[j] > limit) {
+            j--;
+        }
+        ub = (double)row[c] + prefix_v[j] - prefix_v[i];
+        if (j < cols->n) {
+            ub += (double)(limit - prefix_w[j]) * cols->density[j];
+        }
+        if (ub > best) {
+            best = ub;
+        }
+    }
+    return best;
+}
+
+/*
+ * 剪枝动态规划法：物品按密度降序逐行处理，只用一条DP行原地更新。
+ * 处理完前 i 个物品后，容量 c 处的状态最终至多达到 pruned_dp_bound(i, c)，
+ * 它在 c = min(前 i 个物品总重, C) 处最大、向两侧单调下降（两项分数上界都是 c 的凹函数），
+ * 所以能超过当前下界的状态是一个连续的容量窗口（两端见 pruned_dp_edge），每行只计算窗口内的格子。
+ * 窗口外的格子保留之前各行的值：它们仍是某个可行解的价值，最优解经过的状态都在窗口内，不受影响。
+ * 下界先取贪心解，之后每行用 row[C] 提高；某一行的窗口为空，或窗口内的实际状态加上其余物品的
+ * 分数上界都不能超过下界（上下界相遇），说明下界已是最优，提前结束。
+ */
+int solve_pruned_dp(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    ItemColumns cols;
+    long long* prefix_w;
+    double* prefix_v;
+    value_t* row;
+    unsigned char* keep_row;    /* 行内核按容量下标写选取位的整行缓冲，每行只把窗口内的字节复制出去 */
+    unsigned char** keep;       /* keep[i] 的第0字节对应容量 win_lo[i] & ~7 */
+    int* win_lo;
+    int* win_hi;
+    value_t best = 0;
+    int best_row = 0;           /* 0 表示下界来自贪心解，否则为 row[C] 取得下界时的行号 */
+    long long greedy_weight = 0, cells = 0;
+    int i, c, m, status;
+
+    solver_phase(solver, result, KNAPSACK_PHASE_SORT);
+    status = item_columns_build(&solver->arena, items, solver->file, n, C, ITEM_ORDER_DENSITY, &cols);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    m = cols.n;
+    prefix_w = (long long*)knapsack_arena_alloc(&solver->arena, (m + 1) * sizeof(long long));
+    prefix_v = (double*)knapsack_arena_alloc(&solver->arena, (m + 1) * sizeof(double));
+    row = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+    keep_row = (unsigned char*)knapsack_arena_alloc(&solver->arena, DP_KEEP_BYTES(C));
+    keep = (unsigned char**)knapsack_arena_alloc(&solver->arena, (m + 1) * sizeof(unsigned char*));
+    win_lo = (int*)knapsack_arena_alloc(&solver->arena, (m + 1) * sizeof(int));
+    win_hi = (int*)knapsack_arena_alloc(&solver->arena, (m + 1) * sizeof(int));
+    if (!prefix_w || !prefix_v || !row || !keep_row || !keep || !win_lo || !win_hi) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    item_columns_prefix(&cols, prefix_w, prefix_v);
+
+    /* 下界：按密度装入，装不下的跳过继续 */
+    for (i = 0; i < m; i++) {
+        if (greedy_weight + cols.weight[i] <= C) {
+            greedy_weight += cols.weight[i];
+            best += cols.value[i];
+        }
+    }
+    result->lower_bound = (double)best;
+    result->upper_bound = fractional_bound(cols.density, prefix_w, prefix_v, m, 0, C);
+    for (c = 0; c <= C; c++) {
+        row[c] = 0;
+    }
+
+    for (i = 1; i <= m; i++) {
+        int peak = prefix_w[i] < C ? (int)prefix_w[i] : C;
+
+        if (BOUND_CANNOT_IMPROVE(pruned_dp_bound(&cols, prefix_w, prefix_v, i, peak, C), best)) {
+            break;
+        }
+        win_lo[i] = pruned_dp_edge(&cols, prefix_w, prefix_v, i, C, best, 0, peak, i > 1 ? win_lo[i-1] : peak);
+        win_hi[i] = pruned_dp_edge(&cols, prefix_w, prefix_v, i, C, best, C, peak, i > 1 ? win_hi[i-1] : peak);
+
+        /* 只为窗口覆盖的字节保留选取标记，访问时容量先减去窗口起点所在字节的偏移 */
+        keep[i] = (unsigned char*)knapsack_arena_alloc(&solver->arena, (win_hi[i] >> 3) - (win_lo[i] >> 3) + 1);
+        if (!keep[i]) {
+            return KNAPSACK_ERR_NOMEM;
+        }
+        dp_row_kernel(row, row, keep_row, win_lo[i], win_hi[i], cols.weight[i-1], cols.value[i-1]);
+        memcpy(keep[i], keep_row + (win_lo[i] >> 3), (win_hi[i] >> 3) - (win_lo[i] >> 3) + 1);
+        cells += win_hi[i] - win_lo[i] + 1;
+        if (row[C] > best) {
+            best = row[C];
+            best_row = i;
+        }
+        if (BOUND_CANNOT_IMPROVE(pruned_dp_row_bound(&cols, prefix_w, prefix_v, row, i, win_lo[i], win_hi[i], C), best)) {
+            i++;
+            break;
+        }
+        if (solver->progress && (m < 10 || i % (m / 10) == 0)) {
+            solver->progress(solver->progress_user, i, m);
+        }
+    }
+    result->rows_filled = i - 1;
+    result->cells_computed = cells;
+    result->cells_skipped = (long long)n * (C + 1) - cells;
+
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    if (best_row == 0) {
+        greedy_weight = 0;
+        for (i = 0; i < m; i++) {
+            if (greedy_weight + cols.weight[i] <= C) {
+                greedy_weight += cols.weight[i];
+                result->selection[cols.index[i]] = 1;
+            }
+        }
+    } else {
+        c = C;
+        for (i = best_row; i > 0; i--) {
+            if (c >= win_lo[i] && c <= win_hi[i] && DP_KEEP_GET(keep[i], c - (win_lo[i] & ~7))) {
+                result->selection[cols.index[i-1]] = 1;
+                c -= cols.weight[i-1];
+            }
+        }
+    }
+    return KNAPSACK_OK;
+}
+
+void pruned_dp_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("剪枝动态规划法开始计算（贪心下界 + 分数上界确定每行的容量窗口）...\n");
+    if (console_solve("剪枝动态规划法", items, n, C, KNAPSACK_ALGO_PRUNED_DP, "已处理物品", &result)) {
+        double total = (double)n * (C + 1);
+        printf("剪枝动态规划法: 贪心下界 %.2f，分数上界 %.2f，填写 %d / %d 行，计算 %lld 个格子，跳过 %lld 个 (%.2f%%)\n",
+               VALUE_TO_DOUBLE(result.lower_bound), VALUE_TO_DOUBLE(result.upper_bound), result.rows_filled, n,
+               result.cells_computed, result.cells_skipped, total > 0 ? 100.0 * result.cells_skipped / total : 0.0);
+        report_solution("剪枝动态规划法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/*
+ * 稀疏Pareto动态规划法（Nemhauser–Ullmann）：不保存 C+1 个格子，只保存当前物品前缀下
+ * 非支配的 (重量, 价值) 状态表——按重量升序、价值严格递增。每个物品把表整体平移 (w, v)
+ * 后与原表线性归并，去掉被支配的状态，平移后超过 C 的部分不再生成。
+ * 时间和内存与状态数成正比，物品总重远小于 C 时状态表远短于稠密DP的一行。
+ * 每个新状态在内存池中记一个父指针结点（前一状态的结点 + 本物品），最优解沿父指针重构。
+ */
+typedef struct {
+    int parent;     /* 前一状态的结点，-1 为空集 */
+    int item;
+} ParetoNode;
+
+#define PARETO_MAX_NODES (1 << 27)  /* 父指针结点上限（1 GB），超过时返回 KNAPSACK_ERR_TOO_LARGE */
+
+typedef struct {
+    int* weight;
+    value_t* value;
+    int* node;
+    int size;
+    int capacity;
+} ParetoList;
+
+/* 保证 list 能放下 need 个状态；容量不够时换一块更大的内存，原内容不保留 */
+int pareto_list_reserve(KnapsackArena* arena, ParetoList* list, int need) {
+    int capacity = list->capacity > 0 ? list->capacity : 1024;
+    if (need <= list->capacity) {
+        return KNAPSACK_OK;
+    }
+    while (capacity < need) {
+        capacity = capacity > INT_MAX / 2 ? need : capacity * 2;
+    }
+    list->weight = (int*)knapsack_arena_alloc(arena, capacity * sizeof(int));
+    list->value = (value_t*)knapsack_arena_alloc(arena, capacity * sizeof(value_t));
+    list->node = (int*)knapsack_arena_alloc(arena, capacity * sizeof(int));
+    if (!list->weight || !list->value || !list->node) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    list->capacity = capacity;
+    return KNAPSACK_OK;
+}
+
+int solve_pareto_dp(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    ParetoList lists[2];
+    ParetoNode* nodes = NULL;
+    int node_count = 0, node_capacity = 0, cur = 0, max_size = 1;
+    int i, k, status;
+
+    memset(lists, 0, sizeof(lists));
+    status = pareto_list_reserve(&solver->arena, &lists[0], 1);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    lists[0].weight[0] = 0;
+    lists[0].value[0] = 0;
+    lists[0].node[0] = -1;
+    lists[0].size = 1;
+
+    for (i = 0; i < n; i++) {
+        const ParetoList* in = &lists[cur];
+        ParetoList* out = &lists[cur ^ 1];
+        int wi = items[i].weight, m = in->size, a = 0, b = 0;
+        value_t vi = items[i].value, last = -1;
+
+        if (wi > C) {
+            continue;
+        }
+        /* 归并结果不超过 2m 个，也不超过 C+1 个；新结点不超过 m 个 */
+        status = pareto_list_reserve(&solver->arena, out, m <= C / 2 ? 2 * m : C + 1);
+        if (status != KNAPSACK_OK) {
+            return status;
+        }
+        if (node_count + m > node_capacity) {
+            ParetoNode* grown;
+            int capacity = node_capacity > 0 ? node_capacity : 4096;
+            if (node_count + m > PARETO_MAX_NODES) {
+                return KNAPSACK_ERR_TOO_LARGE;
+            }
+            while (capacity < node_count + m) {
+                capacity *= 2;
+            }
+            if (capacity > PARETO_MAX_NODES) {
+                capacity = PARETO_MAX_NODES;
+            }
+            grown = (ParetoNode*)knapsack_arena_alloc(&solver->arena, capacity * sizeof(ParetoNode));
+            if (!grown) {
+                return KNAPSACK_ERR_NOMEM;
+            }
+            if (node_count > 0) {
+                memcpy(grown, nodes, node_count * sizeof(ParetoNode));
+            }
+            nodes = grown;
+            node_capacity = capacity;
+        }
+
+        /* 线性归并原表 in[a] 与平移表 in[b] + (wi, vi)；同重量时只留价值大的一个 */
+        out->size = 0;
+        while (a < m || (b < m && in->weight[b] + wi <= C)) {
+            int w, node, fresh;
+            value_t v;
+            if (b < m && in->weight[b] + wi <= C &&
+                (a >= m || in->weight[b] + wi < in->weight[a] ||
+                 (in->weight[b] + wi == in->weight[a] && in->value[b] + vi > in->value[a]))) {
+                w = in->weight[b] + wi;
+                v = in->value[b] + vi;
+                node = in->node[b];     /* 暂记父结点，保留时再分配新结点 */
+                fresh = 1;
+                if (a < m && in->weight[a] == w) {
+                    a++;
+                }
+                b++;
+            } else {
+                w = in->weight[a];
+                v = in->value[a];
+                node = in->node[a];
+                fresh = 0;
+                if (b < m && in->weight[b] + wi == w) {
+                    b++;
+                }
+                a++;
+            }
+            if (v > last) {
+                if (fresh) {
+                    nodes[node_count].parent = node;
+                    nodes[node_count].item = i;
+                    node = node_count++;
+                }
+                out->weight[out->size] = w;
+                out->value[out->size] = v;
+                out->node[out->size] = node;
+                out->size++;
+                last = v;
+            }
+        }
+        cur ^= 1;
+        if (lists[cur].size > max_size) {
+            max_size = lists[cur].size;
+        }
+        if (solver->progress && (n < 10 || (i + 1) % (n / 10) == 0)) {
+            solver->progress(solver->progress_user, i + 1, n);
+        }
+    }
+
+    /* 价值随重量严格递增，表中最后一个状态即为最优 */
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    for (k = lists[cur].node[lists[cur].size - 1]; k >= 0; k = nodes[k].parent) {
+        result->selection[nodes[k].item] = 1;
+    }
+    result->frontier_max = max_size;
+    result->frontier_nodes = node_count;
+    return KNAPSACK_OK;
+}
+
+void pareto_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("稀疏Pareto动态规划法开始计算（只保留非支配的 (重量, 价值) 状态）...\n");
+    if (console_solve("稀疏Pareto动态规划法", items, n, C, KNAPSACK_ALGO_PARETO_DP, "已处理物品", &result)) {
+        printf("稀疏Pareto动态规划法: 最多 %d 个非支配状态（稠密DP每行 %d 个格子），父指针结点 %lld 个（%.1f MB）\n",
+               result.frontier_max, C + 1, result.frontier_nodes,
+               result.frontier_nodes * sizeof(ParetoNode) / (1024.0 * 1024.0));
+        report_solution("稀疏Pareto动态规划法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/* 贪心法 */
+int solve_greedy(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    ItemColumns cols;
+    int current_weight = 0;
+    int i, status;
+    
+    solver_phase(solver, result, KNAPSACK_PHASE_SORT);
+    status = item_columns_build(&solver->arena, items, solver->file, n, C, ITEM_ORDER_DENSITY, &cols);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+
+    for (i = 0; i < cols.n; i++) {
+        if (current_weight + cols.weight[i] <= C) {
+            result->selection[cols.index[i]] = 1;
+            current_weight += cols.weight[i];
+        }
+    }
+    return KNAPSACK_OK;
+}
+
+void greedy_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+    
+    printf("贪心法开始计算（按价值密度排序）...\n");
+    if (console_solve("贪心法", items, n, C, KNAPSACK_ALGO_GREEDY, NULL, &result)) {
+        report_solution("贪心法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/* 线性时间贪心法划分时同步交换三列的第 a、b 项 */
+void linear_greedy_swap(double* dens, weight_t* wt, int* idx, int a, int b) {
+    double d = dens[a];
+    weight_t w = wt[a];
+    int t = idx[a];
+    dens[a] = dens[b]; wt[a] = wt[b]; idx[a] = idx[b];
+    dens[b] = d; wt[b] = w; idx[b] = t;
+}
+
+/* a[0..n) 插入排序，n 很小时用 */
+void insertion_sort_double(double* a, int n) {
+    int i, j;
+    for (i = 1; i < n; i++) {
+        double x = a[i];
+        for (j = i; j > 0 && a[j - 1] > x; j--) {
+            a[j] = a[j - 1];
+        }
+        a[j] = x;
+    }
+}
+
+/*
+ * 中位数的中位数（BFPRT）：返回 a[0..n) 中第 k 小（0 起）的值，a 的次序被打乱，最坏 O(n)。
+ * 每5个一组取中位数放到数组前部，递归求它们的中位数作主元，主元两侧各至少有约 3/10 的元素。
+ */
+double select_kth_double(double* a, int n, int k) {
+    while (n > 5) {
+        int groups = (n + 4) / 5, g, lt = 0, gt = n, i = 0;
+        double pivot;
+        for (g = 0; g < groups; g++) {
+            int s = g * 5, e = s + 5 < n ? s + 5 : n;
+            double t;
+            insertion_sort_double(a + s, e - s);
+            /* 第 g 个位置属于已处理过的组（或本组），可以放中位数 */
+            t = a[g]; a[g] = a[s + (e - s - 1) / 2]; a[s + (e - s - 1) / 2] = t;
+        }
+        pivot = select_kth_double(a, groups, groups / 2);
+        while (i < gt) {
+            double t = a[i];
+            if (t < pivot) {
+                a[i] = a[lt]; a[lt] = t;
+                lt++;
+                i++;
+            } else if (t > pivot) {
+                gt--;
+                a[i] = a[gt]; a[gt] = t;
+            } else {
+                i++;
+            }
+        }
+        if (k < lt) {
+            n = lt;
+        } else if (k < gt) {
+            return pivot;
+        } else {
+            a += gt;
+            n -= gt;
+            k -= gt;
+        }
+    }
+    insertion_sort_double(a, n);
+    return a[k];
+}
+
+#define LINEAR_GREEDY_SORT_LIMIT 4096   /* 断点之后最多按密度排序的候选物品数 */
+#define LINEAR_GREEDY_MAX_BANDS 64
+
+/*
+ * 线性时间贪心法：不对全部物品排序，而是用加权中位数划分（Balas–Zemel 式）直接找出断点物品——
+ * 密度高于它的物品总重不超过 C、全部装入。主元取当前区间密度的中位数（中位数的中位数选出），
+ * 每轮区间至少减半，最坏也是 O(n)。
+ * 划分时被排除的"小于"部分按密度分成若干段，段与段之间已经有序：断点之后按段依次用剩余容量
+ * 继续装，每段只排序放得下的候选，累计排序超过 LINEAR_GREEDY_SORT_LIMIT 个后不再排序、按列顺序装完这一段就停。
+ * 结果取 max(贪心解, 价值最大的单件物品)，保证不低于最优值的一半，并给出分数上界。
+ */
+int solve_linear_greedy(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    int size = n > 0 ? n : 1;
+    int* idx = (int*)knapsack_arena_alloc(&solver->arena, size * sizeof(int));
+    double* dens = (double*)knapsack_arena_alloc(&solver->arena, size * sizeof(double));
+    weight_t* wt = (weight_t*)knapsack_arena_alloc(&solver->arena, size * sizeof(weight_t));
+    double* scratch = (double*)knapsack_arena_alloc(&solver->arena, size * sizeof(double));
+    int* cand = (int*)knapsack_arena_alloc(&solver->arena, size * sizeof(int));
+    unsigned long long* key = (unsigned long long*)knapsack_arena_alloc(&solver->arena, size * sizeof(unsigned long long));
+    unsigned long long* key_tmp = (unsigned long long*)knapsack_arena_alloc(&solver->arena, size * sizeof(unsigned long long));
+    int* idx_tmp = (int*)knapsack_arena_alloc(&solver->arena, size * sizeof(int));
+    int* selection = result->selection;
+    int band_end[LINEAR_GREEDY_MAX_BANDS];
+    int bands = 0, band_start;
+    int lo = 0, hi, i, m;
+    int break_item = -1;
+    long long remaining = C;
+    value_t greedy_value = 0, single_value = 0;
+    int single_item = -1, sorted = 0;
+    double upper_bound;
+
+    if (!idx || !dens || !wt || !scratch || !cand || !key || !key_tmp || !idx_tmp) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+
+    /* 重量超过 C 的物品不可能装入；其余物品的密度、重量、下标按列存放，划分时三列一起交换 */
+    m = 0;
+    for (i = 0; i < n; i++) {
+        if (items[i].weight <= C) {
+            if (items[i].weight > WEIGHT_MAX) {
+                return KNAPSACK_ERR_TOO_LARGE;
+            }
+            idx[m] = i;
+            dens[m] = items[i].density;
+            wt[m] = (weight_t)items[i].weight;
+            m++;
+        }
+    }
+    hi = m;
+    band_start = m;
+
+    /* 在列的 [lo, hi) 中找断点：每轮按主元密度三路划分为 大于 / 等于 / 小于 */
+    while (lo < hi) {
+        double pivot;
+        int lt = lo, gt = hi, k = lo;
+        long long w_greater = 0, w_equal = 0;
+
+        memcpy(scratch, dens + lo, (hi - lo) * sizeof(double));
+        pivot = select_kth_double(scratch, hi - lo, (hi - lo) / 2);
+
+        while (k < gt) {
+            double d = dens[k];
+            if (d > pivot) {
+                linear_greedy_swap(dens, wt, idx, k, lt);
+                w_greater += wt[lt];
+                lt++;
+                k++;
+            } else if (d < pivot) {
+                gt--;
+                linear_greedy_swap(dens, wt, idx, k, gt);
+            } else {
+                w_equal += wt[k];
+                k++;
+            }
+        }
+
+        if (w_greater > remaining) {
+            /* 断点在"大于"部分；[lt, hi) 成为断点之后的一段，段数满了就并入后一段 */
+            if (lt < hi && bands < LINEAR_GREEDY_MAX_BANDS) {
+                band_end[bands++] = hi;
+            }
+            hi = lt;
+        } else if (w_greater + w_equal > remaining) {
+            remaining -= w_greater;     /* "大于"部分全装，断点在"等于"部分 */
+            for (k = lo; k < lt; k++) selection[idx[k]] = 1;
+            for (k = lt; k < gt; k++) {
+                if (wt[k] > remaining) {
+                    break_item = idx[k];
+                    break;
+                }
+                selection[idx[k]] = 1;
+                remaining -= wt[k];
+            }
+            /* 断点之后依次是：等于部分的其余物品、[gt, hi)、之前排除的各段 */
+            band_start = k + 1;
+            if (hi > gt && bands < LINEAR_GREEDY_MAX_BANDS) {
+                band_end[bands++] = hi;
+            }
+            if (gt > band_start && bands < LINEAR_GREEDY_MAX_BANDS) {
+                band_end[bands++] = gt;
+            }
+            break;
+        } else {
+            remaining -= w_greater + w_equal;   /* 两部分全装，继续在"小于"部分找 */
+            for (k = lo; k < gt; k++) selection[idx[k]] = 1;
+            lo = gt;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        if (selection[i]) {
+            greedy_value += items[i].value;
+        }
+        if (items[i].weight <= C && (single_item < 0 || items[i].value > single_value)) {
+            single_item = i;
+            single_value = items[i].value;
+        }
+    }
+    upper_bound = (double)greedy_value;
+    if (break_item >= 0) {
+        upper_bound += (double)remaining * items[break_item].density;
+    }
+    result->break_item = break_item >= 0 ? items[break_item].id : 0;
+
+    /* 断点之后按段（密度递减）继续装：段内只排序放得下的候选，超出排序上限的那一段按列顺序装 */
+    while (break_item >= 0 && bands > 0 && remaining > 0) {
+        int end = band_end[--bands], count = 0;
+        for (i = band_start; i < end; i++) {
+            if (wt[i] <= remaining) {
+                cand[count] = i;
+                key[count] = ~order_key_double(dens[i]);
+                count++;
+            }
+        }
+        band_start = end;
+        if (sorted + count <= LINEAR_GREEDY_SORT_LIMIT) {
+            radix_sort_keys(key, cand, count, key_tmp, idx_tmp);
+            sorted += count;
+        } else {
+            bands = 0;
+        }
+        for (i = 0; i < count; i++) {
+            if (wt[cand[i]] <= remaining) {
+                selection[idx[cand[i]]] = 1;
+                remaining -= wt[cand[i]];
+                greedy_value += items[idx[cand[i]]].value;
+            }
+        }
+    }
+    result->sorted_items = sorted;
+
+    /* 1/2 近似：贪心解与最大单件物品取较大者 */
+    if (single_item >= 0 && single_value > greedy_value) {
+        memset(selection, 0, n * sizeof(int));
+        selection[single_item] = 1;
+        result->single_item = 1;
+    }
+    result->upper_bound = upper_bound;
+    return KNAPSACK_OK;
+}
+
+void linear_greedy_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("线性时间贪心法开始计算（加权中位数划分找断点物品）...\n");
+    if (!console_solve("线性时间贪心法", items, n, C, KNAPSACK_ALGO_LINEAR_GREEDY, NULL, &result)) {
+        return;
+    }
+    printf("线性时间贪心法: 断点物品编号 %d，断点后参与排序的物品 %d 个\n",
+           result.break_item, result.sorted_items);
+    if (result.single_item) {
+        printf("线性时间贪心法: 最大单件物品优于贪心解，改为只装该物品\n");
+    }
+    printf("线性时间贪心法: 近似保证 结果 >= 最优值/2，分数上界 %.2f\n", VALUE_TO_DOUBLE(result.upper_bound));
+    report_solution("线性时间贪心法", items, n, C, &result, start, csv_filename);
+}
+
+/* FPTAS 中的大物品：缩放后的价值等级、重量、在排序数组中的下标 */
+typedef struct {
+    int q;
+    int weight;
+    int index;
+} FptasItem;
+
+/* 比较函数，按价值等级升序、同等级按重量升序排序 */
+int compareFptasItems(const void* a, const void* b) {
+    FptasItem* itemA = (FptasItem*)a;
+    FptasItem* itemB = (FptasItem*)b;
+    if (itemA->q != itemB->q) return itemA->q - itemB->q;
+    return itemA->weight - itemB->weight;
+}
+
+/* FPTAS 回溯用的选择位表（大物品数 × 价值状态数 位）的内存预算 */
+#define FPTAS_KEEP_BUDGET (512 << 20)
+
+/* 参与计算的物品不超过这个数时直接用折半搜索求精确解，每半至多 2^16 个子集 */
+#define FPTAS_EXACT_MAX_N 32
+
+/* 按密度排好序的小物品前缀中，总重不超过 R 的最长前缀的长度 */
+int fptas_small_prefix(const long long* prefix_w, int m, long long R) {
+    int lo = 0, hi = m;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (prefix_w[mid] <= R) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+/*
+ * 完全多项式时间近似方案（FPTAS，Lawler 式大小物品划分）：
+ * 先用贪心得到下界 LB（LB <= 最优值 <= 2LB），取 δ = ε/3。价值大于 δ·LB 的"大物品"按 K 缩放价值后
+ * 做以价值为下标的最小重量DP，与 C 无关；每个价值等级剩下的容量用按密度排好序的"小物品"前缀填充。
+ * 一个解至多含 min(nl, 2/δ) 件大物品（nl 为大物品数），每件舍入损失不到 K，取 K = 2δ·LB / min(nl, 2/δ)
+ * （不超过 δ·LB，使每件大物品至少一个等级）时舍入损失不超过 2δ·LB，状态数不超过 min(nl/δ, 2/δ²)，
+ * 物品少时不再按 1/ε² 放大；小物品前缀损失不超过 δ·LB，因此结果不低于 (1-ε)·最优值。
+ * 物品不超过 FPTAS_EXACT_MAX_N 个时直接用折半搜索求精确解。
+ */
+int solve_fptas(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    double epsilon = solver->epsilon;
+    ItemColumns cols;
+    long long* prefix_w = (long long*)knapsack_arena_alloc(&solver->arena, (n + 1) * sizeof(long long));
+    double* prefix_v = (double*)knapsack_arena_alloc(&solver->arena, (n + 1) * sizeof(double));
+    int* small = (int*)knapsack_arena_alloc(&solver->arena, (n > 0 ? n : 1) * sizeof(int));
+    FptasItem* large = (FptasItem*)knapsack_arena_alloc(&solver->arena, (n > 0 ? n : 1) * sizeof(FptasItem));
+    int* selection = result->selection;
+    int* minw = NULL;
+    unsigned char* keep = NULL;
+    int i, j, t, m = 0, nl = 0, kept = 0, P, best_p = 0, best_k = 0, status;
+    int greedy_count = 0, single_item = -1;
+    long long weight_sum = 0, qsum = 0;
+    size_t row_bytes;
+    double greedy_value = 0, single_value = 0, lower, upper, delta, threshold, K;
+    double best_estimate = -1, result_value = 0;
+
+    if (epsilon < 0.001) epsilon = 0.001;   /* 状态数 18/ε²，ε 再小内存就不够了 */
+    if (epsilon > 0.5) epsilon = 0.5;
+    if (!prefix_w || !prefix_v || !small || !large) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_SORT);
+    status = item_columns_build(&solver->arena, items, solver->file, n, C, ITEM_ORDER_DENSITY, &cols);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    result->epsilon = epsilon;
+
+    /* 物品很少时精确解比缩放DP还便宜：按排序列组成物品数组求解，再按 index 映射回原顺序 */
+    if (cols.n <= FPTAS_EXACT_MAX_N) {
+        Item* exact = (Item*)knapsack_arena_alloc(&solver->arena, (cols.n > 0 ? cols.n : 1) * sizeof(Item));
+        int* exact_selection = (int*)knapsack_arena_calloc(&solver->arena, cols.n > 0 ? cols.n : 1, sizeof(int));
+        KnapsackResult sub = *result;
+        if (!exact || !exact_selection) {
+            return KNAPSACK_ERR_NOMEM;
+        }
+        for (i = 0; i < cols.n; i++) {
+            exact[i].id = i;
+            exact[i].weight = cols.weight[i];
+            exact[i].value = cols.value[i];
+            exact[i].density = cols.density[i];
+        }
+        sub.selection = exact_selection;
+        status = solve_meet_in_middle(solver, exact, cols.n, C, &sub);
+        if (status != KNAPSACK_OK) {
+            return status;
+        }
+        for (i = 0; i < cols.n; i++) {
+            selection[cols.index[i]] = exact_selection[i];
+        }
+        return KNAPSACK_OK;
+    }
+
+    /* 下界：断点之前的贪心前缀与最大单件物品取较大者 */
+    for (i = 0; i < cols.n && weight_sum + cols.weight[i] <= C; i++) {
+        weight_sum += cols.weight[i];
+        greedy_value += (double)cols.value[i];
+    }
+    greedy_count = i;
+    for (i = 0; i < cols.n; i++) {
+        if (single_item < 0 || (double)cols.value[i] > single_value) {
+            single_item = i;
+            single_value = (double)cols.value[i];
+        }
+    }
+    lower = greedy_value > single_value ? greedy_value : single_value;
+    upper = greedy_value;
+    if (greedy_count < cols.n) {
+        upper += (double)(C - weight_sum) * cols.density[greedy_count];   /* 分数上界，不超过 2LB */
+    }
+
+    /* 回溯用的选择位表超出内存预算时逐步放宽 ε，并如实报告实际使用的 ε */
+    for (;;) {
+        delta = epsilon / 3.0;
+        threshold = delta * lower;
+        nl = 0;
+        for (i = 0; i < cols.n && lower > 0; i++) {
+            if ((double)cols.value[i] > threshold) {
+                nl++;
+            }
+        }
+        K = nl > 2 ? 2.0 * threshold / nl : threshold;
+        if (K < delta * threshold) {
+            K = delta * threshold;
+        }
+        P = lower > 0 ? (int)(upper / K) : 0;
+
+        /* 划分大小物品；小物品保持密度顺序并求前缀和 */
+        m = nl = kept = 0;
+        qsum = 0;
+        prefix_w[0] = 0;
+        prefix_v[0] = 0;
+        for (i = 0; i < cols.n && lower > 0; i++) {
+            if ((double)cols.value[i] > threshold) {
+                large[nl].q = (int)((double)cols.value[i] / K);
+                large[nl].weight = cols.weight[i];
+                large[nl].index = i;
+                nl++;
+            } else {
+                small[m] = i;
+                prefix_w[m + 1] = prefix_w[m] + cols.weight[i];
+                prefix_v[m + 1] = prefix_v[m] + (double)cols.value[i];
+                m++;
+            }
+        }
+
+        /* 同一价值等级 q 的物品在价值不超过 P 的解里至多出现 P/q 件，只保留其中最轻的 */
+        qsort(large, nl, sizeof(FptasItem), compareFptasItems);
+        for (i = 0; i < nl; i = j) {
+            int limit;
+            for (j = i; j < nl && large[j].q == large[i].q; j++);
+            limit = P / large[i].q;
+            for (t = i; t < j && t - i < limit; t++) {
+                large[kept++] = large[t];
+                qsum += large[t].q;
+            }
+        }
+        if (qsum < P) P = (int)qsum;
+        if ((double)kept * DP_KEEP_BYTES(P) <= FPTAS_KEEP_BUDGET || epsilon >= 0.5) {
+            break;
+        }
+        epsilon *= 1.5;
+        if (epsilon > 0.5) epsilon = 0.5;
+    }
+    result->epsilon = epsilon;
+    result->lower_bound = lower;
+    result->large_items = nl;
+    result->kept_items = kept;
+    result->small_items = m;
+    result->value_states = P + 1;
+
+    row_bytes = DP_KEEP_BYTES(P);
+    minw = (int*)knapsack_arena_alloc(&solver->arena, (size_t)(P + 1) * sizeof(int));
+    keep = (unsigned char*)knapsack_arena_calloc(&solver->arena, kept > 0 ? (size_t)kept * row_bytes : 1, 1);
+    if (!minw || !keep) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+
+    /* minw[p]: 缩放价值恰为 p 的大物品组合的最小重量，C+1 表示不可达 */
+    minw[0] = 0;
+    for (i = 1; i <= P; i++) {
+        minw[i] = C + 1;
+    }
+    for (j = 0; j < kept; j++) {
+        int q = large[j].q, w = large[j].weight;
+        unsigned char* row = keep + (size_t)j * row_bytes;
+        for (i = P; i >= q; i--) {
+            int cand = minw[i - q] + w;
+            if (cand < minw[i]) {
+                minw[i] = cand;
+                row[i >> 3] |= (unsigned char)(1 << (i & 7));
+            }
+        }
+    }
+
+    /* 每个可达的价值等级：剩余容量装小物品前缀，取估计值最大者 */
+    for (i = 0; i <= P; i++) {
+        if (minw[i] <= C) {
+            int k = fptas_small_prefix(prefix_w, m, C - minw[i]);
+            double estimate = i * K + prefix_v[k];
+            if (estimate > best_estimate) {
+                best_estimate = estimate;
+                best_p = i;
+                best_k = k;
+            }
+        }
+    }
+
+    /* 回溯选出的大物品，再装入小物品前缀 */
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    for (j = kept - 1, i = best_p; j >= 0 && i > 0; j--) {
+        if (DP_KEEP_GET(keep + (size_t)j * row_bytes, i)) {
+            selection[cols.index[large[j].index]] = 1;
+            result_value += (double)cols.value[large[j].index];
+            i -= large[j].q;
+        }
+    }
+    for (i = 0; i < best_k; i++) {
+        selection[cols.index[small[i]]] = 1;
+    }
+    result_value += prefix_v[best_k];
+
+    /* 下界对应的解若更好（舍入使估计偏保守）就直接用它 */
+    if (lower > result_value) {
+        memset(selection, 0, n * sizeof(int));
+        if (greedy_value >= single_value) {
+            for (i = 0; i < greedy_count; i++) selection[cols.index[i]] = 1;
+        } else {
+            selection[cols.index[single_item]] = 1;
+        }
+    }
+    return KNAPSACK_OK;
+}
+
+void fptas_knapsack(Item* items, int n, int C, double epsilon, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    if (epsilon < 0.001) epsilon = 0.001;
+    if (epsilon > 0.5) epsilon = 0.5;
+    printf("FPTAS近似法开始计算（ε = %.4f）...\n", epsilon);
+    if (!console_solver_ready) {
+        knapsack_solver_init(&console_solver);
+        console_solver_ready = 1;
+    }
+    console_solver.epsilon = epsilon;
+    if (!console_solve("FPTAS近似法", items, n, C, KNAPSACK_ALGO_FPTAS, NULL, &result)) {
+        return;
+    }
+    if (result.large_items + result.small_items == 0 && n > 0) {
+        printf("FPTAS近似法: 参与计算的物品不超过 %d 个，直接用折半搜索求得精确解\n", FPTAS_EXACT_MAX_N);
+        report_solution("FPTAS近似法", items, n, C, &result, start, csv_filename);
+        return;
+    }
+    if (result.epsilon > epsilon) {
+        printf("FPTAS近似法: 选择位表超出 %d MB，放宽为 ε = %.4f\n", FPTAS_KEEP_BUDGET >> 20, result.epsilon);
+    }
+    printf("FPTAS近似法: 下界 %.2f，大物品 %d 个（约简后 %d 个），小物品 %d 个，价值状态 %d 个\n",
+           VALUE_TO_DOUBLE(result.lower_bound), result.large_items, result.kept_items,
+           result.small_items, result.value_states);
+    printf("FPTAS近似法: 近似保证 结果 >= (1-%.4f)×最优值\n", result.epsilon);
+    report_solution("FPTAS近似法", items, n, C, &result, start, csv_filename);
+}
+
+/* 回溯法（分支限界）搜索树上的一个结点：前 index 个物品已决定 */
+typedef struct {
+    int index;
+    int weight;
+    value_t value;
+    int state;      /* 0: 新结点  1: 已尝试装入分支  2: 两个分支都已尝试 */
+} BranchBoundFrame;
+
+/*
+ * 回溯法求解上下文：所有状态都在这里，没有全局变量，多个上下文可以同时求解。
+ * 用显式栈代替递归，深度最多 n+1；上界用前缀和加二分查找，每个结点 O(log n)。
+ */
+typedef struct {
+    ItemColumns cols;           /* 按密度降序排列的物品列 */
+    long long* prefix_w;
+    double* prefix_v;
+    int n;
+    int capacity;
+    value_t best_value;
+    unsigned char* best;        /* 最优解，按列中的下标 */
+    unsigned char* current;     /* 当前路径上的选择 */
+    BranchBoundFrame* stack;
+    long long nodes;            /* 访问的结点数 */
+    long long pruned;           /* 被上界剪掉的结点数 */
+} BranchBoundContext;
+
+/* 初始化上下文（排序物品、计算前缀和），内存全部取自 arena，返回 KNAPSACK_OK 或错误码 */
+int branch_bound_init(BranchBoundContext* ctx, KnapsackArena* arena, const Item* items,
+                      const KnapsackItemFile* file, int n, int C) {
+    int status;
+    memset(ctx, 0, sizeof(*ctx));
+    status = item_columns_build(arena, items, file, n, C, ITEM_ORDER_DENSITY, &ctx->cols);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    n = ctx->cols.n;
+    ctx->n = n;
+    ctx->capacity = C;
+    ctx->prefix_w = (long long*)knapsack_arena_alloc(arena, (n + 1) * sizeof(long long));
+    ctx->prefix_v = (double*)knapsack_arena_alloc(arena, (n + 1) * sizeof(double));
+    ctx->best = (unsigned char*)knapsack_arena_calloc(arena, n + 1, 1);
+    ctx->current = (unsigned char*)knapsack_arena_calloc(arena, n + 1, 1);
+    ctx->stack = (BranchBoundFrame*)knapsack_arena_alloc(arena, (n + 1) * sizeof(BranchBoundFrame));
+    if (!ctx->prefix_w || !ctx->prefix_v || !ctx->best || !ctx->current || !ctx->stack) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    item_columns_prefix(&ctx->cols, ctx->prefix_w, ctx->prefix_v);
+    return KNAPSACK_OK;
+}
+
+/* 深度优先分支限界，先尝试装入再尝试不装 */
+void branch_bound_solve(BranchBoundContext* ctx) {
+    int top = 0;
+    int n = ctx->n;
+
+    ctx->best_value = 0;
+    ctx->nodes = 0;
+    ctx->pruned = 0;
+    memset(ctx->best, 0, n);
+
+    ctx->stack[top].index = 0;
+    ctx->stack[top].weight = 0;
+    ctx->stack[top].value = 0;
+    ctx->stack[top].state = 0;
+    top++;
+
+    while (top > 0) {
+        BranchBoundFrame* f = &ctx->stack[top - 1];
+        BranchBoundFrame* child;
+
+        if (f->state == 0) {
+            ctx->nodes++;
+            if (f->index == n) {
+                if (f->value > ctx->best_value) {
+                    ctx->best_value = f->value;
+                    memcpy(ctx->best, ctx->current, n);
+                }
+                top--;
+                continue;
+            }
+            if (BOUND_CANNOT_IMPROVE((double)f->value + fractional_bound(ctx->cols.density, ctx->prefix_w, ctx->prefix_v,
+                                                                           n, f->index, ctx->capacity - f->weight),
+                                     ctx->best_value)) {
+                ctx->pruned++;
+                top--;
+                continue;
+            }
+            f->state = 1;
+            if (f->weight + ctx->cols.weight[f->index] <= ctx->capacity) {
+                ctx->current[f->index] = 1;
+                child = &ctx->stack[top++];
+                child->index = f->index + 1;
+                child->weight = f->weight + ctx->cols.weight[f->index];
+                child->value = f->value + ctx->cols.value[f->index];
+                child->state = 0;
+                continue;
+            }
+        }
+
+        if (f->state == 1) {
+            f->state = 2;
+            ctx->current[f->index] = 0;
+            child = &ctx->stack[top++];
+            child->index = f->index + 1;
+            child->weight = f->weight;
+            child->value = f->value;
+            child->state = 0;
+            continue;
+        }
+
+        top--;
+    }
+}
+
+/*
+ * 并行回溯法：每个线程有自己的任务双端队列，自己从队尾取，空闲时从其他线程的队头窃取。
+ * 有线程空闲时，正在搜索的线程把离根最近的、尚未尝试的"不装"分支打包成任务放进自己的队列。
+ * 当前最优值放在原子变量里，所有线程都用全局最优值剪枝；最优解本身只在改进时加锁写入。
+ * 找不到任务的线程在条件变量上睡眠，有新任务入队或搜索结束时被唤醒，不空转占用CPU。
+ * 没有固定的 N 限制：耗时取决于剪枝效果。solver->node_limit 非0时各线程每 BB_DONATE_INTERVAL 个结点
+ * 汇总一次计数，总数超过上限就置放弃标志，所有线程丢弃手上和队列里的任务后退出。
+ */
+#ifdef _OPENMP
+typedef omp_lock_t bb_lock_t;
+#define bb_lock_init(l) omp_init_lock(l)
+#define bb_lock_destroy(l) omp_destroy_lock(l)
+#define bb_lock(l) omp_set_lock(l)
+#define bb_unlock(l) omp_unset_lock(l)
+#define bb_thread_id() omp_get_thread_num()
+#else
+typedef int bb_lock_t;
+#define bb_lock_init(l) ((void)(l))
+#define bb_lock_destroy(l) ((void)(l))
+#define bb_lock(l) ((void)(l))
+#define bb_unlock(l) ((void)(l))
+#define bb_thread_id() 0
+#endif
+
+/* 空闲线程等待用的互斥量和条件变量 */
+#if defined(_WIN32) || defined(_WIN64)
+typedef struct {
+    CRITICAL_SECTION mutex;
+    CONDITION_VARIABLE cond;
+} bb_signal_t;
+#define bb_signal_init(s) (InitializeCriticalSection(&(s)->mutex), InitializeConditionVariable(&(s)->cond))
+#define bb_signal_destroy(s) DeleteCriticalSection(&(s)->mutex)
+#define bb_signal_lock(s) EnterCriticalSection(&(s)->mutex)
+#define bb_signal_unlock(s) LeaveCriticalSection(&(s)->mutex)
+#define bb_signal_wait(s) SleepConditionVariableCS(&(s)->cond, &(s)->mutex, INFINITE)
+#define bb_signal_broadcast(s) WakeAllConditionVariable(&(s)->cond)
+#else
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} bb_signal_t;
+#define bb_signal_init(s) (pthread_mutex_init(&(s)->mutex, NULL), pthread_cond_init(&(s)->cond, NULL))
+#define bb_signal_destroy(s) (pthread_cond_destroy(&(s)->cond), pthread_mutex_destroy(&(s)->mutex))
+#define bb_signal_lock(s) pthread_mutex_lock(&(s)->mutex)
+#define bb_signal_unlock(s) pthread_mutex_unlock(&(s)->mutex)
+#define bb_signal_wait(s) pthread_cond_wait(&(s)->cond, &(s)->mutex)
+#define bb_signal_broadcast(s) pthread_cond_broadcast(&(s)->cond)
+#endif
+
+#define BB_DONATE_INTERVAL 1024   /* 每访问这么多结点检查一次是否需要分出任务 */
+
+/* 子问题：前 index 个物品的选择记录在 path 中 */
+typedef struct {
+    int index;
+    int weight;
+    value_t value;
+    unsigned char* path;
+} BranchBoundTask;
+
+typedef struct {
+    BranchBoundTask* tasks;
+    int head;           /* 窃取端 */
+    int tail;           /* 所有者端 */
+    int capacity;
+    bb_lock_t lock;
+} BranchBoundDeque;
+
+typedef struct {
+    BranchBoundContext* ctx;        /* 只读：排序后的物品和前缀和 */
+    BranchBoundDeque* deques;
+    int num_threads;
+    _Atomic value_t best_value;     /* 全局最优值，无锁读取和更新 */
+    atomic_int outstanding;         /* 已入队但尚未完成的任务数，为0时搜索结束 */
+    atomic_int idle;                /* 空闲线程数 */
+    atomic_int queued;              /* 各队列中的任务总数，空闲线程据此判断是否醒来 */
+    bb_signal_t signal;             /* 空闲线程在此睡眠 */
+    atomic_llong nodes;
+    atomic_llong pruned;
+    atomic_llong steals;
+    long long node_limit;           /* 0 表示不限 */
+    atomic_int aborted;             /* 访问结点超过上限，放弃搜索 */
+    bb_lock_t best_lock;            /* 保护 ctx->best */
+    value_t best_recorded;
+} ParallelBranchBound;
+
+int bb_deque_push(BranchBoundDeque* dq, BranchBoundTask task) {
+    int ok = 1;
+    bb_lock(&dq->lock);
+    if (dq->tail == dq->capacity) {
+        /* 先把已窃取走的空位压缩掉，仍不够再扩容 */
+        int count = dq->tail - dq->head;
+        if (dq->head > 0) {
+            memmove(dq->tasks, dq->tasks + dq->head, count * sizeof(BranchBoundTask));
+            dq->head = 0;
+            dq->tail = count;
+        }
+        if (dq->tail == dq->capacity) {
+            int new_capacity = dq->capacity * 2;
+            BranchBoundTask* grown = (BranchBoundTask*)realloc(dq->tasks, new_capacity * sizeof(BranchBoundTask));
+            if (grown) {
+                dq->tasks = grown;
+                dq->capacity = new_capacity;
+            } else {
+                ok = 0;
+            }
+        }
+    }
+    if (ok) {
+        dq->tasks[dq->tail++] = task;
+    }
+    bb_unlock(&dq->lock);
+    return ok;
+}
+
+/* from_head 为1时从队头窃取，否则从队尾弹出 */
+int bb_deque_take(BranchBoundDeque* dq, BranchBoundTask* task, int from_head) {
+    int ok = 0;
+    bb_lock(&dq->lock);
+    if (dq->head < dq->tail) {
+        *task = from_head ? dq->tasks[dq->head++] : dq->tasks[--dq->tail];
+        ok = 1;
+    }
+    bb_unlock(&dq->lock);
+    return ok;
+}
+
+/* 先改计数再在互斥量内广播：等待方在互斥量内检查计数，因此不会错过唤醒 */
+void bb_wake_idle(ParallelBranchBound* pbb) {
+    bb_signal_lock(&pbb->signal);
+    bb_signal_broadcast(&pbb->signal);
+    bb_signal_unlock(&pbb->signal);
+}
+
+/* 任务入队：计入 queued 并唤醒空闲线程 */
+int bb_submit(ParallelBranchBound* pbb, int tid, BranchBoundTask task) {
+    if (!bb_deque_push(&pbb->deques[tid], task)) {
+        return 0;
+    }
+    atomic_fetch_add(&pbb->queued, 1);
+    if (atomic_load(&pbb->idle) > 0) {
+        bb_wake_idle(pbb);
+    }
+    return 1;
+}
+
+/* 尝试用叶子结点的值更新全局最优 */
+void bb_offer_incumbent(ParallelBranchBound* pbb, value_t value, const unsigned char* path) {
+    value_t current = atomic_load_explicit(&pbb->best_value, memory_order_relaxed);
+    while (value > current) {
+        if (atomic_compare_exchange_weak(&pbb->best_value, &current, value)) {
+            bb_lock(&pbb->best_lock);
+            if (value > pbb->best_recorded) {
+                pbb->best_recorded = value;
+                memcpy(pbb->ctx->best, path, pbb->ctx->n);
+            }
+            bb_unlock(&pbb->best_lock);
+            return;
+        }
+    }
+}
+
+/* 在一个线程内对任务做深度优先搜索，必要时分出子任务 */
+void bb_run_task(ParallelBranchBound* pbb, BranchBoundTask* task, BranchBoundFrame* stack, unsigned char* current, int tid) {
+    BranchBoundContext* ctx = pbb->ctx;
+    int n = ctx->n;
+    int top = 0;
+    long long nodes = 0, pruned = 0, flushed = 0;
+
+    if (atomic_load(&pbb->aborted)) {
+        return;
+    }
+    memcpy(current, task->path, task->index);
+    stack[top].index = task->index;
+    stack[top].weight = task->weight;
+    stack[top].value = task->value;
+    stack[top].state = 0;
+    top++;
+
+    while (top > 0) {
+        BranchBoundFrame* f = &stack[top - 1];
+        BranchBoundFrame* child;
+
+        if (f->state == 0) {
+            nodes++;
+            if (f->index == n) {
+                bb_offer_incumbent(pbb, f->value, current);
+                top--;
+                continue;
+            }
+            if (BOUND_CANNOT_IMPROVE((double)f->value + fractional_bound(ctx->cols.density, ctx->prefix_w, ctx->prefix_v,
+                                                                           n, f->index, ctx->capacity - f->weight),
+                                     atomic_load_explicit(&pbb->best_value, memory_order_relaxed))) {
+                pruned++;
+                top--;
+                continue;
+            }
+
+            /* 汇总结点数并检查上限 */
+            if (nodes % BB_DONATE_INTERVAL == 0) {
+                long long total = atomic_fetch_add(&pbb->nodes, nodes - flushed) + (nodes - flushed);
+                flushed = nodes;
+                if (atomic_load(&pbb->aborted) || (pbb->node_limit > 0 && total > pbb->node_limit)) {
+                    atomic_store(&pbb->aborted, 1);
+                    break;
+                }
+            }
+
+            /* 有线程空闲时，把离根最近的待尝试"不装"分支交出去 */
+            if (nodes % BB_DONATE_INTERVAL == 0 && atomic_load(&pbb->idle) > 0) {
+                int k;
+                for (k = 0; k < top - 1; k++) {
+                    if (stack[k].state == 1) {
+                        BranchBoundTask donated;
+                        donated.index = stack[k].index + 1;
+                        donated.weight = stack[k].weight;
+                        donated.value = stack[k].value;
+                        donated.path = (unsigned char*)malloc(donated.index > 0 ? donated.index : 1);
+                        if (donated.path) {
+                            memcpy(donated.path, current, stack[k].index);
+                            donated.path[stack[k].index] = 0;
+                            atomic_fetch_add(&pbb->outstanding, 1);
+                            if (bb_submit(pbb, tid, donated)) {
+                                stack[k].state = 2;
+                            } else {
+                                atomic_fetch_sub(&pbb->outstanding, 1);
+                                free(donated.path);
+                            }
+                        }
+                        break;
+                    }
+                }
+            }
+
+            f->state = 1;
+            if (f->weight + ctx->cols.weight[f->index] <= ctx->capacity) {
+                current[f->index] = 1;
+                child = &stack[top++];
+                child->index = f->index + 1;
+                child->weight = f->weight + ctx->cols.weight[f->index];
+                child->value = f->value + ctx->cols.value[f->index];
+                child->state = 0;
+                continue;
+            }
+        }
+
+        if (f->state == 1) {
+            f->state = 2;
+            current[f->index] = 0;
+            child = &stack[top++];
+            child->index = f->index + 1;
+            child->weight = f->weight;
+            child->value = f->value;
+            child->state = 0;
+            continue;
+        }
+
+        top--;
+    }
+
+    atomic_fetch_add(&pbb->nodes, nodes - flushed);
+    atomic_fetch_add(&pbb->pruned, pruned);
+}
+
+/* 并行回溯法：上下文放在求解器的内存池里，任务队列按需增长，单独 malloc */
+int solve_parallel_branch_bound(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    BranchBoundContext ctx;
+    ParallelBranchBound pbb;
+    BranchBoundTask root;
+    int i, status;
+
+    solver_phase(solver, result, KNAPSACK_PHASE_SORT);
+    status = branch_bound_init(&ctx, &solver->arena, items, solver->file, n, C);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+
+    memset(&pbb, 0, sizeof(pbb));
+    pbb.ctx = &ctx;
+    pbb.num_threads = dp_threads;
+    atomic_init(&pbb.best_value, 0);
+    atomic_init(&pbb.outstanding, 1);
+    atomic_init(&pbb.idle, 0);
+    atomic_init(&pbb.queued, 0);
+    atomic_init(&pbb.nodes, 0);
+    atomic_init(&pbb.pruned, 0);
+    atomic_init(&pbb.steals, 0);
+    atomic_init(&pbb.aborted, 0);
+    pbb.node_limit = solver->node_limit;
+    bb_lock_init(&pbb.best_lock);
+    bb_signal_init(&pbb.signal);
+    pbb.deques = (BranchBoundDeque*)calloc(pbb.num_threads, sizeof(BranchBoundDeque));
+    if (!pbb.deques) {
+        status = KNAPSACK_ERR_NOMEM;
+    }
+    for (i = 0; status == KNAPSACK_OK && i < pbb.num_threads; i++) {
+        pbb.deques[i].capacity = 64;
+        pbb.deques[i].tasks = (BranchBoundTask*)malloc(64 * sizeof(BranchBoundTask));
+        bb_lock_init(&pbb.deques[i].lock);
+        if (!pbb.deques[i].tasks) status = KNAPSACK_ERR_NOMEM;
+    }
+    root.index = 0;
+    root.weight = 0;
+    root.value = 0;
+    root.path = (unsigned char*)malloc(1);
+    if (status != KNAPSACK_OK || !root.path || !bb_submit(&pbb, 0, root)) {
+        free(root.path);
+        status = KNAPSACK_ERR_NOMEM;
+    }
+
+    if (status == KNAPSACK_OK) {
+        solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+        #pragma omp parallel num_threads(pbb.num_threads)
+        {
+            int tid = bb_thread_id();
+            BranchBoundFrame* stack = (BranchBoundFrame*)malloc((n + 1) * sizeof(BranchBoundFrame));
+            unsigned char* current = (unsigned char*)calloc(n + 1, 1);
+            BranchBoundTask task;
+
+            while (stack && current && atomic_load(&pbb.outstanding) > 0) {
+                int got = bb_deque_take(&pbb.deques[tid], &task, 0);
+                int k;
+                for (k = 1; !got && k < pbb.num_threads; k++) {
+                    got = bb_deque_take(&pbb.deques[(tid + k) % pbb.num_threads], &task, 1);
+                    if (got) atomic_fetch_add(&pbb.steals, 1);
+                }
+                if (!got) {
+                    /* 登记为空闲（运行中的线程据此分出任务），睡到有任务入队或搜索结束 */
+                    bb_signal_lock(&pbb.signal);
+                    atomic_fetch_add(&pbb.idle, 1);
+                    while (atomic_load(&pbb.queued) == 0 && atomic_load(&pbb.outstanding) > 0) {
+                        bb_signal_wait(&pbb.signal);
+                    }
+                    atomic_fetch_sub(&pbb.idle, 1);
+                    bb_signal_unlock(&pbb.signal);
+                    continue;
+                }
+                atomic_fetch_sub(&pbb.queued, 1);
+                bb_run_task(&pbb, &task, stack, current, tid);
+                free(task.path);
+                if (atomic_fetch_sub(&pbb.outstanding, 1) == 1) {
+                    bb_wake_idle(&pbb);     /* 最后一个任务完成，叫醒所有等待的线程退出 */
+                }
+            }
+            free(stack);
+            free(current);
+        }
+        result->nodes = atomic_load(&pbb.nodes);
+        result->pruned = atomic_load(&pbb.pruned);
+        result->steals = atomic_load(&pbb.steals);
+
+        solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+        if (atomic_load(&pbb.aborted)) {
+            status = KNAPSACK_ERR_TOO_LARGE;
+        }
+        for (i = 0; status == KNAPSACK_OK && i < ctx.n; i++) {
+            if (ctx.best[i]) {
+                result->selection[ctx.cols.index[i]] = 1;
+            }
+        }
+    }
+
+    if (pbb.deques) {
+        for (i = 0; i < pbb.num_threads; i++) {
+            free(pbb.deques[i].tasks);
+            bb_lock_destroy(&pbb.deques[i].lock);
+        }
+        free(pbb.deques);
+    }
+    bb_lock_destroy(&pbb.best_lock);
+    bb_signal_destroy(&pbb.signal);
+    return status;
+}
+
+/* 并行回溯法 */
+void parallel_backtracking_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+
+    printf("并行回溯法开始计算（%d 个线程，任务窃取，共享原子最优值）...\n", dp_threads);
+    if (console_solve("并行回溯法", items, n, C, KNAPSACK_ALGO_PARALLEL_BRANCH_BOUND, NULL, &result)) {
+        printf("并行回溯法: 访问结点 %lld 个，剪枝 %lld 个，窃取任务 %lld 次\n",
+               result.nodes, result.pruned, result.steals);
+        report_solution("并行回溯法", items, n, C, &result, start, csv_filename);
+    } else if (result.status == KNAPSACK_ERR_TOO_LARGE && console_bb_node_limit > 0) {
+        printf("并行回溯法: 访问结点超过 %lld 个（环境变量 KNAPSACK_BB_NODES），剪枝不够有效，已放弃。\n\n",
+               console_bb_node_limit);
+    }
+}
+
+/* 回溯法 */
+int solve_branch_bound(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    BranchBoundContext ctx;
+    int i, status;
+    
+    solver_phase(solver, result, KNAPSACK_PHASE_SORT);
+    status = branch_bound_init(&ctx, &solver->arena, items, solver->file, n, C);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    branch_bound_solve(&ctx);
+    result->nodes = ctx.nodes;
+    result->pruned = ctx.pruned;
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    for (i = 0; i < ctx.n; i++) {
+        if (ctx.best[i]) {
+            result->selection[ctx.cols.index[i]] = 1;
+        }
+    }
+    return KNAPSACK_OK;
+}
+
+void backtracking_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+    
+    printf("回溯法开始计算（带剪枝优化）...\n");
+    if (console_solve("回溯法", items, n, C, KNAPSACK_ALGO_BRANCH_BOUND, NULL, &result)) {
+        printf("回溯法: 访问结点 %lld 个，剪枝 %lld 个\n", result.nodes, result.pruned);
+        report_solution("回溯法", items, n, C, &result, start, csv_filename);
+    }
+}
+
+/*
+ * 可达重量位集：每个物品对位集做一次移位或（bitset_shift_or 见 knapsack_kernel.h），
+ * 只处理 [w, min(前缀总重, C)] 对应的字，前缀总重还小时每个物品只动很少的字。
+ * 不重置内存池，knapsack_solve() 的预处理在分配好选择数组之后调用它。
+ */
+int reachable_fill(KnapsackArena* arena, const Item* items, int n, int C, int with_first, KnapsackReachable* reach) {
+    int words = C / 64 + 1, i, w;
+    long long top = 0;
+    unsigned long long* bits = (unsigned long long*)knapsack_arena_calloc(arena, words, sizeof(unsigned long long));
+    int* first = NULL;
+
+    if (!bits) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    if (with_first) {
+        first = (int*)knapsack_arena_alloc(arena, (size_t)words * 64 * sizeof(int));
+        if (!first) {
+            return KNAPSACK_ERR_NOMEM;
+        }
+        memset(first, 0xFF, (size_t)words * 64 * sizeof(int));
+    }
+    bits[0] = 1;
+    for (i = 0; i < n; i++) {
+        int wt = items[i].weight;
+        if (wt <= 0 || wt > C) {
+            continue;
+        }
+        top = top + wt < C ? top + wt : C;
+        bitset_shift_or(bits, wt >> 6, (int)(top >> 6), wt, first, i);
+    }
+    /* 最后一个字中超过 C 的位只会继续左移，不影响 [0, C]，最后统一清掉 */
+    if ((C & 63) != 63) {
+        bits[words - 1] &= (1ULL << ((C & 63) + 1)) - 1;
+    }
+
+    reach->n = n;
+    reach->C = C;
+    reach->items = items;
+    reach->bits = bits;
+    reach->first = first;
+    reach->reachable = 0;
+    reach->max_weight = 0;
+    for (i = words - 1; i >= 0; i--) {
+        unsigned long long x = bits[i];
+        if (x && reach->max_weight == 0) {
+            for (w = 63; !((x >> w) & 1); w--);
+            reach->max_weight = i * 64 + w;
+        }
+        for (; x; x &= x - 1) {
+            reach->reachable++;
+        }
+    }
+    return KNAPSACK_OK;
+}
+
+int knapsack_reachable_build(KnapsackSolver* solver, const Item* items, int n, int C, int with_first,
+                             KnapsackReachable* reach) {
+    memset(reach, 0, sizeof(*reach));
+    if (!solver || !items || n < 0 || C < 0) {
+        return KNAPSACK_ERR_INVALID;
+    }
+    knapsack_arena_reset(&solver->arena);
+    return reachable_fill(&solver->arena, items, n, C, with_first, reach);
+}
+
+/* first[w] 是重量 w 第一次可达时加入的物品，此前 w - 其重量 已经由更早的物品凑出，沿 first 回溯下标严格递减 */
+int knapsack_reachable_select(const KnapsackReachable* reach, int w, int* selection) {
+    if (!reach || !reach->first || !selection || w < 0 || w > reach->C || !KNAPSACK_REACHABLE(reach, w)) {
+        return KNAPSACK_ERR_INVALID;
+    }
+    memset(selection, 0, (reach->n > 0 ? reach->n : 1) * sizeof(int));
+    while (w > 0) {
+        int i = reach->first[w];
+        selection[i] = 1;
+        w -= reach->items[i].weight;
+    }
+    return KNAPSACK_OK;
+}
+
+/* 位集子集和：求不超过 C 的最大可达重量，并给出恰好凑出它的一组物品 */
+int solve_max_weight(KnapsackSolver* solver, const Item* items, int n, int C, KnapsackResult* result) {
+    KnapsackReachable reach;
+    int status;
+
+    solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+    status = reachable_fill(&solver->arena, items, n, C, 1, &reach);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    result->reachable = reach.reachable;
+    solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+    return knapsack_reachable_select(&reach, reach.max_weight, result->selection);
+}
+
+/* 写入CSV：只有重量，不写总价值，避免与各算法的最优价值混在一起比较 */
+void write_reachable_to_csv(const char* filename, Item* items, int n, int C, const KnapsackResult* result,
+                            double execution_time) {
+    FILE* fp = fopen(filename, "a");
+    int i;
+    if (!fp) {
+        printf("无法打开CSV文件进行写入: %s\n", filename);
+        return;
+    }
+    fprintf(fp, "算法: 位集子集和法（可达重量分析，不求价值最优）\n");
+    fprintf(fp, "执行时间: %.2f ms\n", execution_time);
+    fprintf(fp, "背包容量: %d\n", C);
+    fprintf(fp, "\n");
+    fprintf(fp, "物品编号,重量\n");
+    for (i = 0; i < n; i++) {
+        if (result->selection[i]) {
+            fprintf(fp, "%d,%d\n", items[i].id, items[i].weight);
+        }
+    }
+    fprintf(fp, "\n");
+    fprintf(fp, "可达重量个数: %d\n", result->reachable);
+    fprintf(fp, "最大可达重量: %lld\n", result->total_weight);
+    fprintf(fp, "==========================================\n\n");
+    fclose(fp);
+}
+
+/*
+ * 位集子集和法：结果是可达重量的统计和凑出最大可达重量的一组物品，只打印重量，
+ * 不打印总价值（它不是价值最优解，不应和其他算法的结果放在一起比较）。
+ */
+void reachable_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    double start = wall_time_ms();
+    KnapsackResult result;
+    double execution_time, output_start, output_ms;
+    int i;
+
+    printf("位集子集和法开始计算（%d 个64位字，约 %.1f KB）...\n", C / 64 + 1, (C / 64 + 1) * 8.0 / 1024.0);
+    if (!console_solve("位集子集和法", items, n, C, KNAPSACK_ALGO_MAX_WEIGHT, NULL, &result)) {
+        return;
+    }
+    output_start = wall_time_ms();
+    execution_time = output_start - start;
+    last_total_weight = (int)result.total_weight;
+
+    printf("\n========== [位集子集和法] 可达重量分析 ==========\n");
+    printf("执行时间: %.2f ms\n", execution_time);
+    printf("背包容量: %d\n", C);
+    if (print_selected_items) {
+        printf("\n凑出最大可达重量的物品:\n");
+        printf("%-8s %-8s\n", "物品编号", "重量");
+        printf("--------------------------------\n");
+        for (i = 0; i < n; i++) {
+            if (result.selection[i]) {
+                printf("%-8d %-8d\n", items[i].id, items[i].weight);
+            }
+        }
+    }
+    printf("--------------------------------\n");
+    printf("可达重量: %d 个（共 %d 个容量单元）\n", result.reachable, C + 1);
+    printf("最大可达重量: %lld（%s恰好装满，用到 %d 个物品）\n", result.total_weight,
+           result.total_weight == C ? "可以" : "不能", result.selected_count);
+    printf("说明: 只求重量，不是价值最优解；价值与重量成正比（子集和实例）时才与最优解一致\n");
+    printf("==========================================\n\n");
+    if (csv_filename) {
+        write_reachable_to_csv(csv_filename, items, n, C, &result, execution_time);
+    }
+    output_ms = wall_time_ms() - output_start;
+    report_phases("位集子集和法", n, C, &result, output_ms);
+}
+
+/* 同时选好行更新内核、掩码内核和线程数（可重复调用，结果相同） */
+void knapsack_solver_init(KnapsackSolver* solver) {
+    memset(solver, 0, sizeof(*solver));
+    knapsack_arena_init(&solver->arena);
+    solver->epsilon = 0.001;
+    solver->reach_prepass = 1;
+    dp_kernel_init();
+    mask_block_init();
+    dp_threads_init();
+}
+
+void knapsack_solver_free(KnapsackSolver* solver) {
+    knapsack_arena_free(&solver->arena);
+}
+
+/* 按 algo 分派到对应的求解函数；solver->file 不为 NULL 时物品来自映射的物品文件，items 不用 */
+int knapsack_solve_source(KnapsackSolver* solver, const Item* items, int n, int C,
+                          KnapsackAlgorithm algo, KnapsackResult* result) {
+    const KnapsackItemFile* file = solver ? solver->file : NULL;
+    int perf_fds[PERF_COUNTERS];
+    int status, i;
+
+    memset(result, 0, sizeof(*result));
+    result->perf_cycles = result->perf_instructions = result->perf_cache_misses = -1;
+    if (!solver || (!items && !file) || n < 0 || C < 0 || (int)algo < 0 || algo >= KNAPSACK_ALGO_COUNT) {
+        result->status = KNAPSACK_ERR_INVALID;
+        return result->status;
+    }
+    if (solver->perf) {
+        perf_counters_start(perf_fds);
+    }
+    solver->phase = KNAPSACK_PHASE_ALLOC;
+    solver->phase_start = wall_time_ms();
+    knapsack_arena_reset(&solver->arena);
+    result->selection = (int*)knapsack_arena_calloc(&solver->arena, n > 0 ? n : 1, sizeof(int));
+    status = result->selection ? KNAPSACK_OK : KNAPSACK_ERR_NOMEM;
+
+    /* DP的工作量和内存与容量成正比：先用位集（约 1/64 的代价）求出最大可达重量，容量收紧到它不改变最优解 */
+    result->capacity_bound = C;
+    if (status == KNAPSACK_OK && solver->reach_prepass && (algo == KNAPSACK_ALGO_DP || algo == KNAPSACK_ALGO_LINEAR_DP)) {
+        KnapsackReachable reach;
+        solver_phase(solver, result, KNAPSACK_PHASE_FILL);
+        status = reachable_fill(&solver->arena, items, n, C, 0, &reach);
+        if (status == KNAPSACK_OK) {
+            if (algo == KNAPSACK_ALGO_DP) {
+                result->cells_skipped = (long long)n * (C - reach.max_weight);
+            }
+            C = result->capacity_bound = reach.max_weight;
+        }
+    }
+
+    if (status == KNAPSACK_OK) {
+        switch (algo) {
+            case KNAPSACK_ALGO_GREEDY:               status = solve_greedy(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_LINEAR_GREEDY:        status = solve_linear_greedy(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_FPTAS:                status = solve_fptas(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_DP:                   status = solve_dynamic_programming(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_LINEAR_DP:            status = solve_linear_space_dp(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_WEIGHT_CLASS:         status = solve_weight_class(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_CORE:                 status = solve_core(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_BRANCH_BOUND:         status = solve_branch_bound(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_BRUTE_FORCE:          status = solve_brute_force(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_PARALLEL_BRUTE_FORCE: status = solve_parallel_brute_force(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_MEET_IN_MIDDLE:       status = solve_meet_in_middle(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_PRUNED_DP:            status = solve_pruned_dp(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_PARETO_DP:            status = solve_pareto_dp(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_PARALLEL_BRANCH_BOUND: status = solve_parallel_branch_bound(solver, items, n, C, result); break;
+            case KNAPSACK_ALGO_MAX_WEIGHT:           status = solve_max_weight(solver, items, n, C, result); break;
+            default:                                 status = KNAPSACK_ERR_INVALID; break;
+        }
+    }
+
+    if (status == KNAPSACK_OK) {
+        solver_phase(solver, result, KNAPSACK_PHASE_RECONSTRUCT);
+        for (i = 0; i < n; i++) {
+            if (result->selection[i]) {
+                result->total_value += source_value(items, file, i);
+                result->total_weight += source_weight(items, file, i);
+                result->selected_count++;
+            }
+        }
+    }
+    /* 关闭最后一个阶段；输出阶段由调用方计时 */
+    solver_phase(solver, result, KNAPSACK_PHASE_OUTPUT);
+    if (solver->perf) {
+        perf_counters_stop(perf_fds, result);
+    }
+    result->status = status;
+    return status;
+}
+
+/* 库接口 */
+int knapsack_solve(KnapsackSolver* solver, const Item* items, int n, int C,
+                   KnapsackAlgorithm algo, KnapsackResult* result) {
+    if (solver) {
+        solver->file = NULL;
+    }
+    return knapsack_solve_source(solver, items, n, C, algo, result);
+}
+
+/* 列式求解器只经过 item_columns_build 读物品，把文件交给它即可，不展开 Item 数组 */
+int knapsack_solve_file(KnapsackSolver* solver, const KnapsackItemFile* file, int C,
+                        KnapsackAlgorithm algo, KnapsackResult* result) {
+    int status;
+    switch (algo) {
+        case KNAPSACK_ALGO_GREEDY:
+        case KNAPSACK_ALGO_FPTAS:
+        case KNAPSACK_ALGO_WEIGHT_CLASS:
+        case KNAPSACK_ALGO_CORE:
+        case KNAPSACK_ALGO_BRANCH_BOUND:
+        case KNAPSACK_ALGO_PARALLEL_BRANCH_BOUND:
+        case KNAPSACK_ALGO_PRUNED_DP:
+            break;
+        default:
+            memset(result, 0, sizeof(*result));
+            result->status = KNAPSACK_ERR_INVALID;
+            return result->status;
+    }
+    if (!solver || !file || !file->weight) {
+        memset(result, 0, sizeof(*result));
+        result->status = KNAPSACK_ERR_INVALID;
+        return result->status;
+    }
+    solver->file = file;
+    status = knapsack_solve_source(solver, NULL, file->n, C, algo, result);
+    solver->file = NULL;
+    return status;
+}
+
+/*
+ * 多容量查询建表：与动态规划法相同的按容量分段并行填表，但值行只保留两条交替使用，
+ * 每个物品只留一行选取标记，内存是完整DP表的 1/(8×sizeof(value_t)) 左右。
+ */
+int knapsack_capacity_table_build(KnapsackSolver* solver, const Item* items, int n, int max_capacity,
+                                  KnapsackCapacityTable* table) {
+    value_t* rows[2];
+    unsigned char** keep;
+    int i, C = max_capacity;
+
+    memset(table, 0, sizeof(*table));
+    if (!solver || !items || n < 0 || C < 0) {
+        return KNAPSACK_ERR_INVALID;
+    }
+    knapsack_arena_reset(&solver->arena);
+    rows[0] = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+    rows[1] = (value_t*)knapsack_arena_alloc(&solver->arena, (C + 1) * sizeof(value_t));
+    keep = (unsigned char**)knapsack_arena_alloc(&solver->arena, (n > 0 ? n : 1) * sizeof(unsigned char*));
+    if (!rows[0] || !rows[1] || !keep) {
+        return KNAPSACK_ERR_NOMEM;
+    }
+    for (i = 0; i < n; i++) {
+        keep[i] = (unsigned char*)knapsack_arena_alloc(&solver->arena, DP_KEEP_BYTES(C));
+        if (!keep[i]) {
+            return KNAPSACK_ERR_NOMEM;
+        }
+    }
+
+    #pragma omp parallel num_threads(dp_thread_count(C))
+    {
+        int row, lo, hi, k;
+        dp_thread_slice(C, &lo, &hi);
+        for (k = lo; k <= hi; k++) {
+            rows[0][k] = 0;
+        }
+        #pragma omp barrier
+
+        for (row = 0; row < n; row++) {
+            dp_row_kernel(rows[row & 1], rows[(row + 1) & 1], keep[row], lo, hi, items[row].weight, items[row].value);
+            #pragma omp barrier
+
+            #pragma omp master
+            dp_report_row(solver, row + 1, n);
+        }
+    }
+
+    table->n = n;
+    table->max_capacity = C;
+    table->items = items;
+    table->best = rows[n & 1];
+    table->keep = keep;
+    return KNAPSACK_OK;
+}
+
+/* 与动态规划法的重构相同：从最后一个物品往前，按选取标记扣减容量 */
+int knapsack_capacity_table_select(const KnapsackCapacityTable* table, int capacity, int* selection) {
+    int i, c = capacity;
+
+    if (!table || !selection || capacity < 0 || capacity > table->max_capacity) {
+        return KNAPSACK_ERR_INVALID;
+    }
+    for (i = table->n - 1; i >= 0; i--) {
+        selection[i] = DP_KEEP_GET(table->keep[i], c) ? 1 : 0;
+        if (selection[i]) {
+            c -= table->items[i].weight;
+        }
+    }
+    return KNAPSACK_OK;
+}
+
+/* 增量DP：保证 items / selection / keep / checkpoints 能容纳 count 个物品，按2倍扩容 */
+int incremental_reserve(KnapsackIncremental* state, int count) {
+    int max_items = state->max_items;
+    Item* items;
+    int* selection;
+    unsigned char* keep;
+    value_t* checkpoints;
+
+    if (count <= max_items) {
+        return KNAPSACK_OK;
+    }
+    while (max_items < count) {
+        if (max_items > INT_MAX / 2) {
+            return KNAPSACK_ERR_TOO_LARGE;
+        }
+        max_items *= 2;
+    }
+    items = (Item*)realloc(state->items, max_items * sizeof(Item));
+    if (!items) return KNAPSACK_ERR_NOMEM;
+    state->items = items;
+    selection = (int*)realloc(state->selection, max_items * sizeof(int));
+    if (!selection) return KNAPSACK_ERR_NOMEM;
+    state->selection = selection;
+    keep = (unsigned char*)realloc(state->keep, (size_t)max_items * state->keep_bytes);
+    if (!keep) return KNAPSACK_ERR_NOMEM;
+    state->keep = keep;
+    checkpoints = (value_t*)realloc(state->checkpoints,
+                                    ((size_t)max_items / KNAPSACK_INCREMENTAL_CHECKPOINT + 1) * (state->C + 1) * sizeof(value_t));
+    if (!checkpoints) return KNAPSACK_ERR_NOMEM;
+    state->checkpoints = checkpoints;
+    state->max_items = max_items;
+    return KNAPSACK_OK;
+}
+
+int knapsack_incremental_init(KnapsackIncremental* state, int C) {
+    int k;
+
+    memset(state, 0, sizeof(*state));
+    if (C < 0) {
+        return KNAPSACK_ERR_INVALID;
+    }
+    state->C = C;
+    state->keep_bytes = DP_KEEP_BYTES(C);
+    state->rows[0] = (value_t*)malloc((C + 1) * sizeof(value_t));
+    state->rows[1] = (value_t*)malloc((C + 1) * sizeof(value_t));
+    state->max_items = 1;
+    if (!state->rows[0] || !state->rows[1] || incremental_reserve(state, KNAPSACK_INCREMENTAL_CHECKPOINT) != KNAPSACK_OK) {
+        knapsack_incremental_free(state);
+        return KNAPSACK_ERR_NOMEM;
+    }
+    /* 第0条检查点和前沿行都是空集合的DP行 */
+    for (k = 0; k <= C; k++) {
+        state->rows[0][k] = 0;
+        state->checkpoints[k] = 0;
+    }
+    return KNAPSACK_OK;
+}
+
+void knapsack_incremental_free(KnapsackIncremental* state) {
+    free(state->items);
+    free(state->rows[0]);
+    free(state->rows[1]);
+    free(state->checkpoints);
+    free(state->keep);
+    free(state->selection);
+    memset(state, 0, sizeof(*state));
+}
+
+int knapsack_incremental_append(KnapsackIncremental* state, const Item* item) {
+    int status;
+
+    if (!item || item->weight <= 0 || item->value < 0) {
+        return KNAPSACK_ERR_INVALID;
+    }
+    status = incremental_reserve(state, state->n + 1);
+    if (status != KNAPSACK_OK) {
+        return status;
+    }
+    state->items[state->n++] = *item;
+    return KNAPSACK_OK;
+}
+
+int knapsack_incremental_remove(KnapsackIncremental* state, int id) {
+    int k;
+
+    for (k = 0; k < state->n && state->items[k].id != id; k++) {
+    }
+    if (k == state->n) {
+        return KNAPSACK_ERR_INVALID;
+    }
+    memmove(state->items + k, state->items + k + 1, (state->n - k - 1) * sizeof(Item));
+    state->n--;
+    /* 第 k 个物品之后的选取标记都要重算；前沿行包含该物品时也失效 */
+    if (k < state->valid) {
+        state->valid = k;
+    }
+    if (k < state->frontier_items) {
+        state->frontier_items = -1;
+    }
+    return KNAPSACK_OK;
+}
+
+/*
+ * 把 items[valid, n) 的行补算完：前沿行仍有效时接着它算，否则从 valid 之前最近的检查点开始。
+ * 与多容量查询相同，按容量分段并行，两条工作行交替；每算完一个检查点间隔就把当前行存为检查点。
+ * 共重算 n - first 行，O((n - first)×C)，删除位置越靠前越贵。
+ */
+void incremental_refresh(KnapsackIncremental* state) {
+    int first, start, C = state->C, n = state->n;
+    const value_t* from = NULL;
+
+    if (state->valid == n && state->frontier_items == n) {
+        return;
+    }
+    if (state->frontier_items == state->valid) {
+        first = state->valid;
+    } else {
+        first = state->valid / KNAPSACK_INCREMENTAL_CHECKPOINT * KNAPSACK_INCREMENTAL_CHECKPOINT;
+        from = state->checkpoints + (size_t)(first / KNAPSACK_INCREMENTAL_CHECKPOINT) * (C + 1);
+    }
+    start = state->frontier;
+
+    #pragma omp parallel num_threads(dp_thread_count(C))
+    {
+        int i, lo, hi, cur = start;
+        dp_thread_slice(C, &lo, &hi);
+        if (from && lo <= hi) {
+            memcpy(state->rows[cur] + lo, from + lo, (hi - lo + 1) * sizeof(value_t));
+        }
+        #pragma omp barrier
+
+        for (i = first; i < n; i++) {
+            dp_row_kernel(state->rows[cur], state->rows[cur ^ 1], state->keep + (size_t)i * state->keep_bytes,
+                          lo, hi, state->items[i].weight, state->items[i].value);
+            cur ^= 1;
+            if ((i + 1) % KNAPSACK_INCREMENTAL_CHECKPOINT == 0 && lo <= hi) {
+                memcpy(state->checkpoints + (size_t)((i + 1) / KNAPSACK_INCREMENTAL_CHECKPOINT) * (C + 1) + lo,
+                       state->rows[cur] + lo, (hi - lo + 1) * sizeof(value_t));
+            }
+            #pragma omp barrier
+        }
+    }
+
+    state->frontier = start ^ ((n - first) & 1);
+    state->rows_computed += n - first;
+    state->valid = n;
+    state->frontier_items = n;
+}
+
+int knapsack_incremental_solve(KnapsackIncremental* state, KnapsackResult* result) {
+    int i, c = state->C;
+
+    memset(result, 0, sizeof(*result));
+    incremental_refresh(state);
+    for (i = state->n - 1; i >= 0; i--) {
+        state->selection[i] = DP_KEEP_GET(state->keep + (size_t)i * state->keep_bytes, c) ? 1 : 0;
+        if (state->selection[i]) {
+            c -= state->items[i].weight;
+            result->total_value += state->items[i].value;
+            result->total_weight += state->items[i].weight;
+            result->selected_count++;
+        }
+    }
+    result->selection = state->selection;
+    result->status = KNAPSACK_OK;
+    return KNAPSACK_OK;
+}
+
+/*
+ * 自动规划器的标定结果：启动时测一次，写入缓存文件，内核、线程数和价值类型都相同时直接读取。
+ * 缓存文件默认为当前目录下的 knapsack_calibration.txt，可用环境变量 KNAPSACK_CALIBRATION 指定。
+ */
+typedef struct {
+    char kernel[64];
+    int threads;
+    int value_bytes;
+    double dp_ns;       /* DP 填表每个单元格的耗时（已计入多线程） */
+    double wc_ns;       /* 重量分组法合并一组时每个容量单元的耗时（dp_threads 个线程） */
+    double sort_ns;     /* 排序每次比较的耗时 */
+    double bandwidth;   /* 内存带宽，GB/s */
+} PlannerCalibration;
+
+/* 缓存文件格式版本：标定项的含义改变时加1，旧缓存作废重新标定 */
+#define PLANNER_CALIBRATION_VERSION 2
+
+PlannerCalibration planner_calibration;
+volatile int planner_sink;
+
+/* 标定并缓存，返回 1 表示读取了缓存 */
+int planner_calibrate(const char* kernel_name) {
+    const char* path = getenv("KNAPSACK_CALIBRATION");
+    PlannerCalibration* pc = &planner_calibration;
+    FILE* fp;
+
+    if (!path || !*path) {
+        path = "knapsack_calibration.txt";
+    }
+    fp = fopen(path, "r");
+    if (fp) {
+        PlannerCalibration cached;
+        int version = 0;
+        int ok = fscanf(fp, "%d %63s %d %d %lf %lf %lf %lf", &version, cached.kernel, &cached.threads, &cached.value_bytes,
+                        &cached.dp_ns, &cached.wc_ns, &cached.sort_ns, &cached.bandwidth) == 8;
+        fclose(fp);
+        if (ok && version == PLANNER_CALIBRATION_VERSION && strcmp(cached.kernel, kernel_name) == 0 && cached.threads == dp_threads
+            && cached.value_bytes == (int)sizeof(value_t)) {
+            *pc = cached;
+            return 1;
+        }
+    }
+
+    snprintf(pc->kernel, sizeof(pc->kernel), "%s", kernel_name);
+    pc->threads = dp_threads;
+    pc->value_bytes = (int)sizeof(value_t);
+
+    /* DP 单元格：在 2^20 容量上用与求解器相同的分段并行方式处理 32 个物品 */
+    {
+        int C = 1 << 20, count = 32, i;
+        Item cal[32];
+        value_t* row = (value_t*)malloc((C + 1) * sizeof(value_t));
+        value_t* tmp = dp_thread_count(C) > 1 ? (value_t*)malloc((C + 1) * sizeof(value_t)) : NULL;
+        double t0;
+        for (i = 0; i < count; i++) {
+            cal[i].id = i + 1;
+            cal[i].weight = 1 + (i * 37) % 100;
+            cal[i].value = VALUE_FROM_CENTS(10000 + (i * 7919) % 90000);
+            cal[i].density = (double)cal[i].value / cal[i].weight;
+        }
+        pc->dp_ns = 1.0;
+        if (row) {
+            dp_fill_row(cal, 0, 1, C, row, tmp);    /* 预热，使页面就位 */
+            t0 = wall_time_ms();
+            dp_fill_row(cal, 0, count, C, row, tmp);
+            pc->dp_ns = (wall_time_ms() - t0) * 1e6 / ((double)count * (C + 1));
+        }
+        free(row);
+        free(tmp);
+    }
+
+    /* 重量分组法：重量为16、可选件数不限的一组，做一次完整的合并（转置、逐余数 SMAWK 卷积、转置回去） */
+    {
+        int C = 1 << 18, k;
+        WeightClass wc;
+        value_t* row = (value_t*)malloc((C + 1) * sizeof(value_t));
+        value_t* work = (value_t*)malloc((C + 1) * sizeof(value_t));
+        int* scratch = (int*)malloc((3 * ((size_t)C + 1) + 66 * (size_t)dp_threads) * sizeof(int));
+        double t0;
+        memset(&wc, 0, sizeof(wc));
+        wc.weight = 16;
+        wc.count = wc.kmax = C / 16;
+        wc.prefix = (value_t*)malloc((wc.kmax + 1) * sizeof(value_t));
+        wc.choice32 = (int*)malloc((C + 1) * sizeof(int));
+        pc->wc_ns = 30.0;
+        if (row && work && scratch && wc.prefix && wc.choice32) {
+            for (k = 0; k <= C; k++) {
+                row[k] = VALUE_FROM_CENTS(k % 1000);
+            }
+            /* 增量从80元递减到约39元（凹），总和约 1e8 分，int32 价值下也不溢出 */
+            wc.prefix[0] = 0;
+            for (k = 1; k <= wc.kmax; k++) {
+                wc.prefix[k] = wc.prefix[k - 1] + VALUE_FROM_CENTS(8000 - k / 4);
+            }
+            t0 = wall_time_ms();
+            weight_class_merge(&wc, 0, 1, C, row, work, scratch);
+            pc->wc_ns = (wall_time_ms() - t0) * 1e6 / (C + 1.0);
+        }
+        free(row);
+        free(work);
+        free(scratch);
+        free(wc.prefix);
+        free(wc.choice32);
+    }
+
+    /* 排序：2^17 个物品按密度 qsort */
+    {
+        int count = 1 << 17;
+        Item* items = (Item*)malloc(count * sizeof(Item));
+        double t0;
+        pc->sort_ns = 10.0;
+        if (items) {
+            knapsack_generate(items, count, 12345u, KNAPSACK_GEN_UNCORRELATED);
+            t0 = wall_time_ms();
+            qsort(items, count, sizeof(Item), compareItems);
+            pc->sort_ns = (wall_time_ms() - t0) * 1e6 / ((double)count * 17);
+        }
+        free(items);
+    }
+
+    /* 内存带宽：反复复制 32 MB 缓冲区 */
+    {
+        size_t bytes = (size_t)32 << 20;
+        char* a = (char*)malloc(bytes);
+        char* b = (char*)malloc(bytes);
+        double t0, elapsed;
+        int r;
+        pc->bandwidth = 5.0;
+        if (a && b) {
+            memset(a, 1, bytes);
+            memset(b, 2, bytes);
+            t0 = wall_time_ms();
+            for (r = 0; r < 4; r++) {
+                memcpy(r % 2 ? a : b, r % 2 ? b : a, bytes);
+            }
+            elapsed = wall_time_ms() - t0;
+            planner_sink = a[bytes / 2] + b[bytes - 1];    /* 让复制结果被使用，避免被优化掉 */
+            if (elapsed > 0) {
+                pc->bandwidth = 2.0 * 4 * bytes / (elapsed * 1e6);   /* 读写各算一次 */
+            }
+        }
+        free(a);
+        free(b);
+    }
+
+    fp = fopen(path, "w");
+    if (fp) {
+        fprintf(fp, "%d %s %d %d %.6g %.6g %.6g %.6g\n", PLANNER_CALIBRATION_VERSION, pc->kernel, pc->threads, pc->value_bytes,
+                pc->dp_ns, pc->wc_ns, pc->sort_ns, pc->bandwidth);
+        fclose(fp);
+    }
+    return 0;
+}
+
+/* 内存预算（MB）：环境变量 KNAPSACK_MEM_MB，默认为物理内存的一半 */
+double planner_memory_budget_mb(void) {
+    const char* env = getenv("KNAPSACK_MEM_MB");
+    if (env && atof(env) > 0) {
+        return atof(env);
+    }
+#if defined(_WIN32) || defined(_WIN64)
+    {
+        MEMORYSTATUSEX status;
+        status.dwLength = sizeof(status);
+        if (GlobalMemoryStatusEx(&status)) {
+            return (double)status.ullTotalPhys / (2.0 * 1024 * 1024);
+        }
+    }
+#elif defined(_SC_PHYS_PAGES)
+    {
+        long pages = sysconf(_SC_PHYS_PAGES);
+        long page_size = sysconf(_SC_PAGE_SIZE);
+        if (pages > 0 && page_size > 0) {
+            return (double)pages * page_size / (2.0 * 1024 * 1024);
+        }
+    }
+#endif
+    return 1024.0;
+}
+
+/* 耗时预算（毫秒）：环境变量 KNAPSACK_TIME_MS，默认 60 秒 */
+double planner_time_budget_ms(void) {
+    const char* env = getenv("KNAPSACK_TIME_MS");
+    return (env && atof(env) > 0) ? atof(env) : 60000.0;
+}
+
+/* 一个精确求解器在给定实例上的预估 */
+typedef struct {
+    const char* name;
+    void (*solve)(Item* items, int n, int C, const char* csv_filename);
+    int applicable;     /* 规模限制之内 */
+    int predictable;    /* 耗时只取决于规模；为0时依赖剪枝效果，只在其他算法都超出预算时选用 */
+    double time_ms;
+    double memory_mb;
+} PlannerEstimate;
+
+#define PLANNER_SOLVERS 9
+
+/*
+ * 用标定结果预估每个精确求解器的耗时和峰值内存。核心法和回溯法的工作量取决于实例结构：
+ * 先做一次与核心法相同的排序和翻转上界检验，数出无法用贪心下界固定取值的物品，
+ * 以它们离断点物品的最远距离估计最终核心的大小。
+ */
+void planner_estimate(Item* items, int n, int C, PlannerEstimate* est) {
+    PlannerCalibration* pc = &planner_calibration;
+    const double MB = 1024.0 * 1024.0;
+    double log_n = n > 1 ? log2((double)n) : 1.0;
+    double cells = (double)n * (C + 1);
+    double dp_ns = pc->dp_ns * dp_threads / dp_thread_count(C);
+    double bytes_per_ms = pc->bandwidth * 1e6;
+    double sort_ms = (double)n * log_n * pc->sort_ns / 1e6;
+    double row_bytes = (C + 1.0) * sizeof(value_t);
+    int classes = 0, unfixed = 0, reach = 0, core = 0, break_item, i;
+    int seen[101];
+    KnapsackArena arena;        /* 探测用的排序列和前缀和 */
+    ItemColumns cols;
+    long long* prefix_w;
+    double* prefix_v;
+
+    memset(seen, 0, sizeof(seen));
+    for (i = 0; i < n; i++) {
+        int w = items[i].weight <= 100 ? items[i].weight : 0;
+        if (items[i].weight <= C && (w == 0 || !seen[w])) {
+            classes++;
+            if (w) seen[w] = 1;
+        }
+    }
+
+    /* 实例结构探测 */
+    reach = n;
+    knapsack_arena_init(&arena);
+    prefix_w = (long long*)knapsack_arena_alloc(&arena, (n + 1) * sizeof(long long));
+    prefix_v = (double*)knapsack_arena_alloc(&arena, (n + 1) * sizeof(double));
+    if (prefix_w && prefix_v && item_columns_build(&arena, items, NULL, n, C, ITEM_ORDER_DENSITY, &cols) == KNAPSACK_OK) {
+        double lower = 0;
+        int m = cols.n;
+        item_columns_prefix(&cols, prefix_w, prefix_v);
+        break_item = 0;
+        while (break_item < m && prefix_w[break_item + 1] <= C) {
+            break_item++;
+        }
+
+        /* 下界：与核心法第一轮相同，对断点两侧各16个物品做DP */
+        {
+            int lo = break_item - 16 > 0 ? break_item - 16 : 0;
+            int hi = break_item + 16 < m ? break_item + 16 : m;
+            int residual = (int)(C - prefix_w[lo]);
+            value_t* row = (value_t*)calloc(residual + 1, sizeof(value_t));
+            lower = prefix_v[break_item];
+            if (row) {
+                for (i = lo; i < hi; i++) {
+                    dp_row_update(row, row, NULL, residual, cols.weight[i], cols.value[i]);
+                }
+                if (prefix_v[lo] + (double)row[residual] > lower) {
+                    lower = prefix_v[lo] + (double)row[residual];
+                }
+                free(row);
+            }
+        }
+        reach = 0;
+        for (i = 0; i < m; i++) {
+            double ub;
+            if (i < break_item) {
+                ub = fractional_bound(cols.density, prefix_w, prefix_v, m, 0, (long long)C + cols.weight[i])
+                     - (double)cols.value[i];
+            } else {
+                ub = (double)cols.value[i]
+                     + fractional_bound(cols.density, prefix_w, prefix_v, m, 0, (long long)C - cols.weight[i]);
+            }
+            if (ub > lower) {
+                int dist = i < break_item ? break_item - i : i - break_item + 1;
+                unfixed++;
+                if (dist > reach) reach = dist;
+            }
+        }
+    }
+    knapsack_arena_free(&arena);
+    core = 16;
+    while (core < reach && core < n) {
+        core *= 2;
+    }
+    if (2 * core > n) core = (n + 1) / 2;
+
+    for (i = 0; i < PLANNER_SOLVERS; i++) {
+        est[i].applicable = 1;
+        est[i].predictable = 1;
+    }
+
+    est[0].name = "动态规划法";
+    est[0].solve = dynamic_programming_knapsack;
+    est[0].memory_mb = (n + 1.0) * (row_bytes + DP_KEEP_BYTES(C)) / MB;
+    est[0].time_ms = cells * dp_ns / 1e6 + est[0].memory_mb * MB / bytes_per_ms;
+
+    est[1].name = "线性空间动态规划法";
+    est[1].solve = linear_space_dp_knapsack;
+    est[1].memory_mb = (3.0 * row_bytes + n * sizeof(int)) / MB;
+    est[1].time_ms = 2.0 * cells * dp_ns / 1e6;
+
+    est[2].name = "重量分组法";
+    est[2].solve = weight_class_knapsack;
+    /* 分段保存选择表：一段的选择表加上各段的检查点行，之前的段回溯时重算一遍 */
+    {
+        int seg = weight_class_segment(classes, C, sizeof(unsigned short));
+        int segments = classes > 0 ? (classes + seg - 1) / seg : 0;
+        est[2].memory_mb = (2.0 * row_bytes + 3.0 * (C + 1.0) * sizeof(int)
+                            + seg * (C + 1.0) * sizeof(unsigned short) + (segments > 1 ? segments - 1 : 0) * row_bytes
+                            + n * (sizeof(Item) + sizeof(value_t))) / MB;
+        est[2].time_ms = (2.0 * classes - (classes < seg ? classes : seg)) * (C + 1.0) * pc->wc_ns / 1e6 + sort_ms;
+    }
+
+    /* 核心法：核心 [break-core, break+core)，残余容量约为前一半核心的重量，扩展轮数几何求和约 2 倍 */
+    est[3].name = "核心法";
+    est[3].solve = core_knapsack;
+    {
+        double core_items = 2.0 * core;
+        double residual = core * 50.5 < C ? core * 50.5 : C;
+        est[3].memory_mb = (n * (sizeof(Item) + 2 * sizeof(double) + sizeof(int))
+                            + core_items * residual / 8 + residual * sizeof(value_t)) / MB;
+        est[3].time_ms = sort_ms + 2.0 * core_items * residual * pc->dp_ns * dp_threads / 1e6
+                         + 2.0 * n * log_n * pc->sort_ns / 1e6;
+    }
+
+    /* 回溯法：最坏 2^(n+1) 个结点；并行版按无法固定的物品数估计搜索树 */
+    est[4].name = "回溯法";
+    est[4].solve = backtracking_knapsack;
+    est[4].applicable = n <= 25;
+    est[4].memory_mb = n * (sizeof(Item) + 2 * sizeof(double) + sizeof(BranchBoundFrame) + 2.0) / MB;
+    est[4].time_ms = sort_ms + ldexp(1.0, n < 62 ? n + 1 : 62) * log_n * pc->sort_ns / 1e6;
+
+    est[5].name = "并行回溯法";
+    est[5].solve = parallel_backtracking_knapsack;
+    est[5].predictable = 0;
+    est[5].memory_mb = est[4].memory_mb * (dp_threads + 1);
+    est[5].time_ms = sort_ms + ldexp(1.0, unfixed < 62 ? unfixed : 62) * log_n * pc->sort_ns / 1e6 / dp_threads;
+
+    est[6].name = "蛮力法";
+    est[6].solve = brute_force_knapsack;
+    est[6].applicable = n <= 30;
+    est[6].memory_mb = n * sizeof(int) * 2.0 / MB;
+    est[6].time_ms = ldexp(1.0, n < 62 ? n : 62) * pc->sort_ns / 1e6;
+
+    est[7].name = "并行蛮力法";
+    est[7].solve = parallel_brute_force_knapsack;
+    est[7].applicable = n <= 36;
+    est[7].memory_mb = (n * sizeof(int) + 2.0 * 5 * 256 * sizeof(value_t)) / MB;
+    est[7].time_ms = ldexp(1.0, n < 62 ? n : 62) * pc->sort_ns / 8 / 1e6 / dp_threads;
+
+    est[8].name = "折半搜索法";
+    est[8].solve = meet_in_middle_knapsack;
+    est[8].applicable = n <= 60;
+    {
+        double half = ldexp(1.0, (n + 1) / 2 < 62 ? (n + 1) / 2 : 62);
+        double entries = half < C + 1.0 ? half : C + 1.0;
+        est[8].memory_mb = 3.0 * entries * sizeof(SubsetSum) / MB;
+        est[8].time_ms = 2.0 * (n + 1) / 2 * entries * pc->sort_ns / 1e6;
+    }
+}
+
+/* 选出满足内存和耗时预算、预估最快的精确求解器；优先考虑耗时可预测的算法，找不到返回 -1 */
+int planner_choose(const PlannerEstimate* est, double memory_budget_mb, double time_budget_ms) {
+    int pass, i, best = -1;
+    for (pass = 1; pass >= 0 && best < 0; pass--) {
+        for (i = 0; i < PLANNER_SOLVERS; i++) {
+            if (!est[i].applicable || est[i].predictable != pass) continue;
+            if (est[i].memory_mb > memory_budget_mb || est[i].time_ms > time_budget_ms) continue;
+            if (best < 0 || est[i].time_ms < est[best].time_ms) best = i;
+        }
+    }
+    return best;
+}
+
+/* 自动模式：打印各求解器的预估，运行选中的精确求解器；都超出预算时退回 FPTAS 近似法 */
+void auto_knapsack(Item* items, int n, int C, const char* csv_filename) {
+    PlannerEstimate est[PLANNER_SOLVERS];
+    double memory_budget = planner_memory_budget_mb();
+    double time_budget = planner_time_budget_ms();
+    int i, choice;
+
+    planner_estimate(items, n, C, est);
+    printf("自动规划: 内存预算 %.0f MB (KNAPSACK_MEM_MB)，耗时预算 %.0f ms (KNAPSACK_TIME_MS)\n",
+           memory_budget, time_budget);
+    printf("%-20s %-12s %-12s %s\n", "算法", "预估耗时(ms)", "预估内存(MB)", "说明");
+    for (i = 0; i < PLANNER_SOLVERS; i++) {
+        if (!est[i].applicable) {
+            printf("%-20s %-12s %-12s 超出规模限制\n", est[i].name, "-", "-");
+            continue;
+        }
+        printf("%-20s %-12.3g %-12.3g %s%s%s\n", est[i].name, est[i].time_ms, est[i].memory_mb,
+               est[i].memory_mb > memory_budget ? "超出内存预算 " : "",
+               est[i].time_ms > time_budget ? "超出耗时预算 " : "",
+               est[i].predictable ? "" : "依赖剪枝效果");
+    }
+
+    choice = planner_choose(est, memory_budget, time_budget);
+    if (choice < 0) {
+        printf("自动规划: 没有满足预算的精确算法，改用 FPTAS 近似法（ε = 0.001）\n\n");
+        fptas_knapsack(items, n, C, 0.001, csv_filename);
+        return;
+    }
+    printf("自动规划: 选择 %s\n\n", est[choice].name);
+    est[choice].solve(items, n, C, csv_filename);
+}
+
+/* 以下为控制台程序（批量测试、菜单、main）；作为库嵌入时用 -DKNAPSACK_NO_MAIN 去掉 */
+#ifndef KNAPSACK_NO_MAIN
+
+/*
+ * 命令行批量测试：对 N × C × 算法 的网格，每个配置先预热 warmup 次、再重复测量 repeat 次，
+ * 同时记录单调墙钟时间和进程CPU时间，把中位数、P95、平均值和标准差追加到结果CSV中
+ * （0-1backpage.py 可以直接读取）。求解器自身的控制台输出在测量期间被丢弃。
+ *
+ *   0_1backpage --n 1000,2000 --c 10000,100000 --algo greedy,dp,core --seed 1 --warmup 1 --repeat 5 --out bench.csv
+ *
+ * 随机物品由 --seed 和实例类型 --family（逗号分隔，见 batch_families）决定，与机器和线程数无关，
+ * 同一组参数在任何地方重跑得到相同的实例。
+ *
+ * --queries 给出一组容量时，对每个 N 只填一遍表到其中的最大容量（见 knapsack_capacity_table_build），
+ * 回答所有容量的最优值并逐个重构选择；不再另给 --algo 时只运行这一项：
+ *
+ *   0_1backpage --n 10000 --queries 1000,5000,20000,100000 --repeat 5 --out bench.csv
+ *
+ * --updates K 模拟物品集合的持续变化：对每个 N、C 先建好增量DP状态（见 knapsack_incremental_init），
+ * 再做 K 轮"随机删除一个旧物品、追加一个新物品、重新求解"，统计每轮刷新的耗时和重算行数：
+ *
+ *   0_1backpage --n 10000 --c 10000 --updates 50 --out bench.csv
+ *
+ * --items 指定物品文件（见 knapsack.h）时不再生成随机物品，N 取文件中的物品数；
+ * 再加 --import 时先把文本文件导入为该物品文件：
+ *
+ *   0_1backpage --import items.csv --items items.kpi --c 100000 --algo core,fptas
+ *
+ * --record 给出运行记录文件时，每次求解（含预热）另追加一行分阶段耗时和计数（见 write_run_record），
+ * --perf 1 同时用 perf_event_open 统计CPU周期、指令和缓存未命中；菜单模式用环境变量
+ * KNAPSACK_RUN_LOG 和 KNAPSACK_PERF 打开同样的功能：
+ *
+ *   0_1backpage --n 40000 --c 100000 --algo dp --repeat 1 --record runs.csv --perf 1
+ */
+typedef struct {
+    const char* key;
+    const char* name;
+    void (*solve)(Item* items, int n, int C, const char* csv_filename);
+    int max_n;              /* 超过该物品数时跳过，0 表示不限 */
+    long long max_cells;    /* n×C 超过该值时跳过，0 表示不限 */
+    int weight_only;        /* 为1时结果是最大可达重量而不是价值，总价值一列留空 */
+} BatchAlgorithm;
+
+double batch_epsilon = 0.001;
+
+void batch_fptas(Item* items, int n, int C, const char* csv_filename) {
+    fptas_knapsack(items, n, C, batch_epsilon, csv_filename);
+}
+
+BatchAlgorithm batch_algorithms[] = {
+    {"greedy", "贪心法", greedy_knapsack, 0, 0, 0},
+    {"linear_greedy", "线性时间贪心法", linear_greedy_knapsack, 0, 0, 0},
+    {"fptas", "FPTAS近似法", batch_fptas, 0, 0, 0},
+    {"dp", "动态规划法", dynamic_programming_knapsack, 0, 400000000LL, 0},
+    {"linear_dp", "线性空间动态规划法", linear_space_dp_knapsack, 0, 0, 0},
+    {"weight_class", "重量分组法", weight_class_knapsack, 0, 0, 0},
+    {"core", "核心法", core_knapsack, 0, 0, 0},
+    {"backtracking", "回溯法", backtracking_knapsack, 25, 0, 0},
+    {"parallel_bb", "并行回溯法", parallel_backtracking_knapsack, 0, 0, 0},
+    {"brute", "蛮力法", brute_force_knapsack, 30, 0, 0},
+    {"parallel_brute", "并行蛮力法", parallel_brute_force_knapsack, 36, 0, 0},
+    {"mitm", "折半搜索法", meet_in_middle_knapsack, 60, 0, 0},
+    {"pruned_dp", "剪枝动态规划法", pruned_dp_knapsack, 0, 0, 0},
+    {"pareto", "稀疏Pareto动态规划法", pareto_knapsack, 0, 0, 0},
+    {"reach", "位集子集和法", reachable_knapsack, 0, 0, 1},
+    {"auto", "自动选择", auto_knapsack, 0, 0, 0}
+};
+
+#define BATCH_ALGORITHMS ((int)(sizeof(batch_algorithms) / sizeof(batch_algorithms[0])))
+
+/* --items 时能直接在映射的物品文件上求解的算法（列式求解器），返回对应的库算法；其余返回 -1，要先展开为 Item 数组 */
+int batch_file_algorithm(const BatchAlgorithm* alg) {
+    if (alg->solve == greedy_knapsack) return KNAPSACK_ALGO_GREEDY;
+    if (alg->solve == batch_fptas) return KNAPSACK_ALGO_FPTAS;
+    if (alg->solve == weight_class_knapsack) return KNAPSACK_ALGO_WEIGHT_CLASS;
+    if (alg->solve == core_knapsack) return KNAPSACK_ALGO_CORE;
+    if (alg->solve == backtracking_knapsack) return KNAPSACK_ALGO_BRANCH_BOUND;
+    if (alg->solve == parallel_backtracking_knapsack) return KNAPSACK_ALGO_PARALLEL_BRANCH_BOUND;
+    if (alg->solve == pruned_dp_knapsack) return KNAPSACK_ALGO_PRUNED_DP;
+    return -1;
+}
+
+/* --family 的取值，与 KnapsackInstanceFamily 一一对应 */
+const char* batch_families[KNAPSACK_GEN_COUNT] = {
+    "uncorrelated", "weak", "strong", "inverse_strong", "almost_strong", "subset_sum"
+};
+#define BATCH_MAX_LIST 64
+
+/* 把 stdout 暂时指向空设备，返回恢复用的文件描述符 */
+int stdout_silence(void) {
+    int saved;
+    fflush(stdout);
+#if defined(_WIN32) || defined(_WIN64)
+    saved = _dup(_fileno(stdout));
+    freopen("NUL", "w", stdout);
+#else
+    saved = dup(fileno(stdout));
+    if (!freopen("/dev/null", "w", stdout)) {
+        return saved;
+    }
+#endif
+    return saved;
+}
+
+void stdout_restore(int saved) {
+    if (saved < 0) return;
+    fflush(stdout);
+#if defined(_WIN32) || defined(_WIN64)
+    _dup2(saved, _fileno(stdout));
+    _close(saved);
+#else
+    dup2(saved, fileno(stdout));
+    close(saved);
+#endif
+    clearerr(stdout);
+}
+
+/* 解析逗号分隔的整数列表，返回个数；有不是整数或超出 int 范围的项时返回 -1 */
+int parse_int_list(const char* text, int* out, int max_count) {
+    int count = 0;
+    while (*text && count < max_count) {
+        char* end;
+        long long v = strtoll(text, &end, 10);
+        if (end == text || (*end != ',' && *end != '\0') || v < INT_MIN || v > INT_MAX) {
+            return -1;
+        }
+        out[count++] = (int)v;
+        text = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* 对 samples 排序后计算中位数、P95（最近秩）、平均值和样本标准差 */
+void sample_stats(double* samples, int count, double* median, double* p95, double* mean, double* stddev) {
+    int i, rank;
+    double sum = 0, sq = 0;
+    qsort(samples, count, sizeof(double), compareDoubles);
+    *median = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    rank = (int)ceil(0.95 * count) - 1;
+    *p95 = samples[rank < 0 ? 0 : rank];
+    for (i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    *mean = sum / count;
+    for (i = 0; i < count; i++) {
+        sq += (samples[i] - *mean) * (samples[i] - *mean);
+    }
+    *stddev = count > 1 ? sqrt(sq / (count - 1)) : 0.0;
+}
+
+/*
+ * 多容量查询：计时的是建表（一遍DP）加上重构全部 count 个选择；
+ * 每个容量写一行结果，墙钟和CPU时间为整批查询共用的时间。
+ */
+void batch_capacity_queries(FILE* fp, Item* items, int n, const int* queries, int count,
+                            unsigned long long seed, int warmup, int repeat,
+                            const char* kernel_name, const char* family_key, const char* family_name) {
+    KnapsackSolver solver;
+    KnapsackCapacityTable table;
+    double* wall = (double*)malloc(repeat * sizeof(double));
+    double* cpu = (double*)malloc(repeat * sizeof(double));
+    int* selection = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    double w_med, w_p95, w_mean, w_std, c_med, c_p95, c_mean, c_std;
+    int q, r, i, max_c = 0, status = KNAPSACK_OK;
+
+    for (q = 0; q < count; q++) {
+        if (queries[q] > max_c) max_c = queries[q];
+    }
+    if (!wall || !cpu || !selection) {
+        free(wall);
+        free(cpu);
+        free(selection);
+        return;
+    }
+    knapsack_solver_init(&solver);
+    for (r = 0; r < warmup + repeat && status == KNAPSACK_OK; r++) {
+        double t0 = wall_time_ms();
+        clock_t c0 = clock();
+        status = knapsack_capacity_table_build(&solver, items, n, max_c, &table);
+        for (q = 0; q < count && status == KNAPSACK_OK; q++) {
+            status = knapsack_capacity_table_select(&table, queries[q], selection);
+        }
+        clock_t c1 = clock();
+        double t1 = wall_time_ms();
+        if (r >= warmup) {
+            wall[r - warmup] = t1 - t0;
+            cpu[r - warmup] = (double)(c1 - c0) / CLOCKS_PER_SEC * 1000.0;
+        }
+    }
+    if (status != KNAPSACK_OK) {
+        fprintf(stderr, "多容量查询失败: N=%d 最大容量 %d（%s）\n", n, max_c,
+                status == KNAPSACK_ERR_NOMEM ? "内存不足" : "容量无效");
+    } else {
+        sample_stats(wall, repeat, &w_med, &w_p95, &w_mean, &w_std);
+        sample_stats(cpu, repeat, &c_med, &c_p95, &c_mean, &c_std);
+        printf("queries      %-14s N=%-7d %d 个容量一遍填表到 C=%d: 墙钟中位数 %10.3f ms  P95 %10.3f ms  CPU %10.3f ms\n",
+               family_key, n, count, max_c, w_med, w_p95, c_med);
+        for (q = 0; q < count; q++) {
+            long long weight = 0;
+            knapsack_capacity_table_select(&table, queries[q], selection);
+            for (i = 0; i < n; i++) {
+                if (selection[i]) weight += items[i].weight;
+            }
+            printf("    C=%-8d 总价值 %-12.2f 总重量 %lld\n", queries[q], VALUE_TO_DOUBLE(table.best[queries[q]]), weight);
+            fprintf(fp, "%s,%d,%d,%llu,%d,%d,%.2f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%s,%s,%s\n",
+                    "多容量查询法", n, queries[q], seed, warmup, repeat, VALUE_TO_DOUBLE(table.best[queries[q]]),
+                    w_med, w_p95, w_mean, w_std, c_med, dp_threads, kernel_name, VALUE_TYPE_NAME, family_name);
+        }
+        fflush(fp);
+    }
+    knapsack_solver_free(&solver);
+    free(wall);
+    free(cpu);
+    free(selection);
+}
+
+/*
+ * 增量更新：物品池多生成 rounds 个（计数器随机数发生器下前 n 个与原实例相同），
+ * 第 r 轮删除的位置也由 (种子, r) 决定。计时的是每轮的 knapsack_incremental_solve()。
+ */
+void batch_incremental_updates(FILE* fp, int n, int C, int rounds, unsigned long long seed,
+                               KnapsackInstanceFamily family, const char* kernel_name) {
+    KnapsackIncremental state;
+    KnapsackResult result;
+    Item* pool = (Item*)malloc(((size_t)n + rounds) * sizeof(Item));
+    double* wall = (double*)malloc(rounds * sizeof(double));
+    double* cpu = (double*)malloc(rounds * sizeof(double));
+    double w_med, w_p95, w_mean, w_std, c_med, c_p95, c_mean, c_std, build_ms, t0;
+    long long rows_before;
+    int i, r;
+
+    if (!pool || !wall || !cpu || knapsack_incremental_init(&state, C) != KNAPSACK_OK) {
+        fprintf(stderr, "N=%d C=%d: 增量DP内存分配失败\n", n, C);
+        free(pool);
+        free(wall);
+        free(cpu);
+        return;
+    }
+    knapsack_generate(pool, n + rounds, seed, family);
+    for (i = 0; i < n; i++) {
+        knapsack_incremental_append(&state, &pool[i]);
+    }
+    t0 = wall_time_ms();
+    knapsack_incremental_solve(&state, &result);
+    build_ms = wall_time_ms() - t0;
+    rows_before = state.rows_computed;
+
+    for (r = 0; r < rounds; r++) {
+        philox4x32_t x = philox4x32((unsigned long long)r, 1, seed);
+        clock_t c0;
+        knapsack_incremental_remove(&state, state.items[random_below(x.v[0], state.n)].id);
+        knapsack_incremental_append(&state, &pool[n + r]);
+        t0 = wall_time_ms();
+        c0 = clock();
+        knapsack_incremental_solve(&state, &result);
+        cpu[r] = (double)(clock() - c0) / CLOCKS_PER_SEC * 1000.0;
+        wall[r] = wall_time_ms() - t0;
+    }
+    sample_stats(wall, rounds, &w_med, &w_p95, &w_mean, &w_std);
+    sample_stats(cpu, rounds, &c_med, &c_p95, &c_mean, &c_std);
+    printf("updates      %-14s N=%-7d C=%-8d 总价值 %-12.2f 首次建表 %10.3f ms  每轮刷新中位数 %10.3f ms  P95 %10.3f ms  平均重算 %.0f 行\n",
+           batch_families[family], n, C, VALUE_TO_DOUBLE(result.total_value), build_ms, w_med, w_p95,
+           (double)(state.rows_computed - rows_before) / rounds);
+    fprintf(fp, "%s,%d,%d,%llu,%d,%d,%.2f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%s,%s,%s\n",
+            "增量动态规划法", n, C, seed, 0, rounds, VALUE_TO_DOUBLE(result.total_value),
+            w_med, w_p95, w_mean, w_std, c_med, dp_threads, kernel_name, VALUE_TYPE_NAME, instance_family_names[family]);
+    fflush(fp);
+    knapsack_incremental_free(&state);
+    free(pool);
+    free(wall);
+    free(cpu);
+}
+
+void batch_usage(const char* prog) {
+    int a, f;
+    fprintf(stderr, "用法: %s --n 1000,2000 --c 10000 --algo greedy,dp --seed 1 --family uncorrelated,strong --warmup 1 --repeat 5 --out bench.csv\n", prog);
+    fprintf(stderr, "      %s [--import items.csv] --items items.kpi --c 10000 --algo greedy,dp\n", prog);
+    fprintf(stderr, "      %s --n 10000 --queries 1000,5000,20000 --repeat 5 --out bench.csv\n", prog);
+    fprintf(stderr, "      %s --n 10000 --c 10000 --updates 50 --out bench.csv\n", prog);
+    fprintf(stderr, "      %s --n 40000 --c 100000 --algo dp --repeat 1 --record runs.csv --perf 1\n", prog);
+    fprintf(stderr, "--n、--c 为逗号分隔的正整数\n");
+    fprintf(stderr, "算法:");
+    for (a = 0; a < BATCH_ALGORITHMS; a++) fprintf(stderr, " %s", batch_algorithms[a].key);
+    fprintf(stderr, "\n实例类型:");
+    for (f = 0; f < KNAPSACK_GEN_COUNT; f++) fprintf(stderr, " %s", batch_families[f]);
+    fprintf(stderr, "\n");
+}
+
+int batch_main(int argc, char* argv[], const char* kernel_name) {
+    int n_list[BATCH_MAX_LIST] = {1000}, c_list[BATCH_MAX_LIST] = {10000};
+    int algo_list[BATCH_MAX_LIST];
+    int query_list[BATCH_MAX_LIST];
+    int query_count = 0, algo_given = 0, update_rounds = 0;
+    int family_list[BATCH_MAX_LIST] = {KNAPSACK_GEN_UNCORRELATED};
+    int n_count = 1, c_count = 1, algo_count = 0, family_count = 0;
+    unsigned long long seed = 1;
+    int warmup = 1, repeat = 5;
+    const char* out_path = "knapsack_bench.csv";
+    const char* algo_text = "greedy,dp";
+    const char* family_text = "uncorrelated";
+    const char* items_path = NULL;
+    const char* import_path = NULL;
+    KnapsackItemFile item_file;
+    int i, a, f, fi, ni, ci, r;
+    FILE* fp;
+
+    for (i = 1; i < argc; i++) {
+        const char* opt = argv[i];
+        const char* val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!val) {
+            fprintf(stderr, "参数 %s 缺少取值\n", opt);
+            return 1;
+        }
+        if (strcmp(opt, "--n") == 0 || strcmp(opt, "--c") == 0) {
+            int* list = opt[2] == 'n' ? n_list : c_list;
+            int count = parse_int_list(val, list, BATCH_MAX_LIST);
+            for (a = 0; a < count && list[a] >= 1; a++);
+            if (count <= 0 || a < count) {
+                fprintf(stderr, "%s 的取值无效: %s\n", opt, val);
+                batch_usage(argv[0]);
+                return 1;
+            }
+            if (opt[2] == 'n') n_count = count; else c_count = count;
+        } else if (strcmp(opt, "--algo") == 0) {
+            algo_text = val;
+            algo_given = 1;
+        } else if (strcmp(opt, "--updates") == 0) {
+            update_rounds = atoi(val);
+        } else if (strcmp(opt, "--queries") == 0) {
+            query_count = parse_int_list(val, query_list, BATCH_MAX_LIST);
+            if (query_count <= 0) {
+                fprintf(stderr, "--queries 需要逗号分隔的容量列表\n");
+                return 1;
+            }
+        } else if (strcmp(opt, "--seed") == 0) {
+            seed = strtoull(val, NULL, 10);
+        } else if (strcmp(opt, "--family") == 0) {
+            family_text = val;
+        } else if (strcmp(opt, "--warmup") == 0) {
+            warmup = atoi(val);
+        } else if (strcmp(opt, "--repeat") == 0) {
+            repeat = atoi(val);
+        } else if (strcmp(opt, "--epsilon") == 0) {
+            batch_epsilon = atof(val);
+            /* 与 fptas_knapsack 相同的范围，直接在物品文件上求解时也适用 */
+            if (batch_epsilon < 0.001) batch_epsilon = 0.001;
+            if (batch_epsilon > 0.5) batch_epsilon = 0.5;
+        } else if (strcmp(opt, "--out") == 0) {
+            out_path = val;
+        } else if (strcmp(opt, "--record") == 0) {
+            run_record_path = val;
+        } else if (strcmp(opt, "--perf") == 0) {
+            console_perf = atoi(val);
+        } else if (strcmp(opt, "--items") == 0) {
+            items_path = val;
+        } else if (strcmp(opt, "--import") == 0) {
+            import_path = val;
+        } else {
+            fprintf(stderr, "未知参数: %s\n", opt);
+            batch_usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    /* 解析算法列表（只给 --queries 或 --updates 时不运行其他算法） */
+    if ((query_count > 0 || update_rounds > 0) && !algo_given) {
+        algo_text = "";
+    }
+    while (*algo_text && algo_count < BATCH_MAX_LIST) {
+        size_t len = strcspn(algo_text, ",");
+        for (a = 0; a < BATCH_ALGORITHMS; a++) {
+            if (strlen(batch_algorithms[a].key) == len && strncmp(batch_algorithms[a].key, algo_text, len) == 0) break;
+        }
+        if (a == BATCH_ALGORITHMS) {
+            fprintf(stderr, "未知算法: %.*s\n", (int)len, algo_text);
+            return 1;
+        }
+        algo_list[algo_count++] = a;
+        algo_text += len;
+        if (*algo_text == ',') algo_text++;
+    }
+    /* 解析实例类型列表 */
+    while (*family_text && family_count < BATCH_MAX_LIST) {
+        size_t len = strcspn(family_text, ",");
+        for (f = 0; f < KNAPSACK_GEN_COUNT; f++) {
+            if (strlen(batch_families[f]) == len && strncmp(batch_families[f], family_text, len) == 0) break;
+        }
+        if (f == KNAPSACK_GEN_COUNT) {
+            fprintf(stderr, "未知实例类型: %.*s\n", (int)len, family_text);
+            return 1;
+        }
+        family_list[family_count++] = f;
+        family_text += len;
+        if (*family_text == ',') family_text++;
+    }
+    for (i = 0; i < query_count; i++) {
+        if (query_list[i] < 0) {
+            fprintf(stderr, "查询容量不能为负: %d\n", query_list[i]);
+            return 1;
+        }
+    }
+    if (update_rounds > 0 && items_path) {
+        fprintf(stderr, "--updates 需要随机生成新物品，不能与 --items 同时使用\n");
+        return 1;
+    }
+    if (n_count == 0 || c_count == 0 || (algo_count == 0 && query_count == 0 && update_rounds <= 0) ||
+        family_count == 0 || repeat < 1 || warmup < 0) {
+        fprintf(stderr, "网格为空或重复次数无效\n");
+        return 1;
+    }
+
+    /* 物品来自文件时 N 由文件决定 */
+    if (import_path) {
+        int imported, status;
+        double t0 = wall_time_ms();
+        if (!items_path) {
+            fprintf(stderr, "--import 需要同时用 --items 指定输出的物品文件\n");
+            return 1;
+        }
+        status = knapsack_item_file_import_csv(import_path, items_path, &imported);
+        if (status == KNAPSACK_ERR_INVALID) {
+            fprintf(stderr, "导入失败: %s 第 %d 行不是\"重量,价值\"格式（超过511字节、数值为负或价值超出 %s 的表示范围）\n",
+                    import_path, imported, VALUE_TYPE_NAME);
+            return 1;
+        } else if (status != KNAPSACK_OK) {
+            fprintf(stderr, "导入失败: 无法读取 %s 或写入 %s\n", import_path, items_path);
+            return 1;
+        }
+        printf("已导入 %d 个物品: %s -> %s（%.1f ms）\n", imported, import_path, items_path, wall_time_ms() - t0);
+    }
+    if (items_path) {
+        double t0 = wall_time_ms();
+        if (knapsack_item_file_open(&item_file, items_path) != KNAPSACK_OK) {
+            fprintf(stderr, "无法打开物品文件或格式不符: %s\n", items_path);
+            return 1;
+        }
+        printf("物品文件 %s: %d 个物品，最大重量 %d，映射耗时 %.3f ms\n",
+               items_path, item_file.n, item_file.max_weight, wall_time_ms() - t0);
+        n_list[0] = item_file.n;
+        n_count = 1;
+        family_count = 1;
+    }
+
+    /* 结果文件：新文件先写表头，之后追加 */
+    fp = fopen(out_path, "a");
+    if (!fp) {
+        fprintf(stderr, "无法打开结果文件: %s\n", out_path);
+        return 1;
+    }
+    if (ftell(fp) == 0) {
+        fprintf(fp, "算法,N,C,种子,预热次数,重复次数,总价值,墙钟中位数 (ms),墙钟P95 (ms),墙钟平均 (ms),墙钟标准差 (ms),"
+                    "CPU中位数 (ms),线程数,DP行内核,价值类型,实例类型\n");
+    }
+
+    print_selected_items = 0;
+    for (fi = 0; fi < family_count; fi++) {
+        KnapsackInstanceFamily family = (KnapsackInstanceFamily)family_list[fi];
+        for (ni = 0; ni < n_count; ni++) {
+            int n = n_list[ni];
+            Item* items = NULL;
+            /* 物品来自文件时，列式求解器直接读映射的列，只有其余算法和多容量查询才展开为 Item 数组 */
+            int need_items = !items_path || query_count > 0;
+            for (a = 0; a < algo_count && !need_items; a++) {
+                need_items = batch_file_algorithm(&batch_algorithms[algo_list[a]]) < 0;
+            }
+            if (n <= 0) {
+                fprintf(stderr, "N=%d: N无效\n", n);
+                continue;
+            }
+            if (items_path && !item_file_values_fit(&item_file)) {
+                fprintf(stderr, "N=%d: 物品总价值超出 %s 的表示范围\n", n, VALUE_TYPE_NAME);
+                continue;
+            }
+            if (need_items) {
+                items = (Item*)malloc(n * sizeof(Item));
+                if (!items) {
+                    fprintf(stderr, "N=%d: 内存分配失败\n", n);
+                    continue;
+                }
+                if (items_path) {
+                    double t0 = wall_time_ms();
+                    if (knapsack_item_file_items(&item_file, items) != KNAPSACK_OK) {
+                        fprintf(stderr, "物品文件中有重量不为正、价值为负或价值超出 %s 表示范围的物品: %s\n",
+                                VALUE_TYPE_NAME, items_path);
+                        free(items);
+                        continue;
+                    }
+                    printf("展开为物品数组耗时 %.3f ms\n", wall_time_ms() - t0);
+                } else {
+                    /* 同一种子、同一实例类型下物品 i 只由 i 决定，与N、C和算法无关 */
+                    knapsack_generate(items, n, seed, family);
+                    if (!values_fit_value_type(items, n)) {
+                        fprintf(stderr, "N=%d: 物品总价值超出 %s 的表示范围\n", n, VALUE_TYPE_NAME);
+                        free(items);
+                        continue;
+                    }
+                }
+            }
+
+            if (query_count > 0) {
+                batch_capacity_queries(fp, items, n, query_list, query_count, seed, warmup, repeat, kernel_name,
+                                       items_path ? "file" : batch_families[family],
+                                       items_path ? items_path : instance_family_names[family]);
+            }
+            for (ci = 0; ci < c_count; ci++) {
+                int C = c_list[ci];
+                if (update_rounds > 0) {
+                    batch_incremental_updates(fp, n, C, update_rounds, seed, family, kernel_name);
+                }
+                for (a = 0; a < algo_count; a++) {
+                    BatchAlgorithm* alg = &batch_algorithms[algo_list[a]];
+                    int file_algo = items_path ? batch_file_algorithm(alg) : -1;
+                    double* wall = (double*)malloc(repeat * sizeof(double));
+                    double* cpu = (double*)malloc(repeat * sizeof(double));
+                    double w_med, w_p95, w_mean, w_std, c_med, c_p95, c_mean, c_std;
+                    char result_text[64], value_text[32];
+                    KnapsackResult file_result;
+
+                    if ((alg->max_n && n > alg->max_n) || (alg->max_cells && (long long)n * C > alg->max_cells)) {
+                        printf("%-12s %-14s N=%-7d C=%-8d 超出规模限制，跳过\n",
+                               alg->key, items_path ? "file" : batch_families[family], n, C);
+                        free(wall);
+                        free(cpu);
+                        continue;
+                    }
+                    if (!wall || !cpu) {
+                        free(wall);
+                        free(cpu);
+                        continue;
+                    }
+                    last_total_value = 0;
+                    last_total_weight = 0;
+                    last_solve_status = KNAPSACK_OK;
+                    for (r = 0; r < warmup + repeat && last_solve_status == KNAPSACK_OK; r++) {
+                        int saved = stdout_silence();
+                        double t0 = wall_time_ms();
+                        clock_t c0 = clock();
+                        if (file_algo >= 0) {
+                            console_solver_prepare(NULL);
+                            console_solver.epsilon = batch_epsilon;
+                            last_solve_status = knapsack_solve_file(&console_solver, &item_file, C,
+                                                                    (KnapsackAlgorithm)file_algo, &file_result);
+                            last_total_value = file_result.total_value;
+                            last_total_weight = (int)file_result.total_weight;
+                        } else {
+                            alg->solve(items, n, C, NULL);
+                        }
+                        clock_t c1 = clock();
+                        double t1 = wall_time_ms();
+                        /* 菜单的求解函数在 report_phases 里写运行记录，直接在文件上求解时在计时之外补上 */
+                        if (file_algo >= 0 && last_solve_status == KNAPSACK_OK && run_record_path) {
+                            write_run_record(run_record_path, alg->name, n, C, &file_result, 0.0);
+                        }
+                        stdout_restore(saved);
+                        if (r >= warmup) {
+                            wall[r - warmup] = t1 - t0;
+                            cpu[r - warmup] = (double)(c1 - c0) / CLOCKS_PER_SEC * 1000.0;
+                        }
+                    }
+                    if (last_solve_status != KNAPSACK_OK) {
+                        printf("%-12s %-14s N=%-7d C=%-8d 求解失败（%s），不记录\n",
+                               alg->key, items_path ? "file" : batch_families[family], n, C, status_text(last_solve_status));
+                        free(wall);
+                        free(cpu);
+                        continue;
+                    }
+                    sample_stats(wall, repeat, &w_med, &w_p95, &w_mean, &w_std);
+                    sample_stats(cpu, repeat, &c_med, &c_p95, &c_mean, &c_std);
+
+                    if (alg->weight_only) {
+                        snprintf(result_text, sizeof(result_text), "最大重量 %-10d", last_total_weight);
+                        value_text[0] = '\0';
+                    } else {
+                        snprintf(result_text, sizeof(result_text), "总价值 %-12.2f", VALUE_TO_DOUBLE(last_total_value));
+                        snprintf(value_text, sizeof(value_text), "%.2f", VALUE_TO_DOUBLE(last_total_value));
+                    }
+                    printf("%-12s %-14s N=%-7d C=%-8d %s 墙钟中位数 %10.3f ms  P95 %10.3f ms  标准差 %8.3f ms  CPU %10.3f ms\n",
+                           alg->key, items_path ? "file" : batch_families[family], n, C, result_text,
+                           w_med, w_p95, w_std, c_med);
+                    fprintf(fp, "%s,%d,%d,%llu,%d,%d,%s,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%s,%s,%s\n",
+                            alg->name, n, C, seed, warmup, repeat, value_text,
+                            w_med, w_p95, w_mean, w_std, c_med, dp_threads, kernel_name, VALUE_TYPE_NAME,
+                            items_path ? items_path : instance_family_names[family]);
+                    fflush(fp);
+                    free(wall);
+                    free(cpu);
+                }
+            }
+            free(items);
+        }
+    }
+    print_selected_items = 1;
+    if (items_path) {
+        knapsack_item_file_close(&item_file);
+    }
+    fclose(fp);
+    printf("结果已追加至: %s\n", out_path);
+    return 0;
+}
+
+/* 显示菜单 */
+void show_menu() {
+    printf("\n=========== 0-1背包问题===========\n");
+    printf("支持的物品数量: 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000, 20000, 40000, 80000, 160000, 320000\n");
+    printf("支持的背包容量: 10000, 100000, 1000000\n");
+    printf("物品重量范围: 1-100\n");
+    printf("物品价值范围: 100.00-1000.00\n");
+    printf("================================================\n");
+}
+
+/* 检查输入有效性 */
+int is_valid_n(int n) {
+    int valid_n[] = {1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000, 20000, 40000, 80000, 160000, 320000};
+    int i;
+    for (i = 0; i < sizeof(valid_n)/sizeof(valid_n[0]); i++) {
+        if (n == valid_n[i]) return 1;
+    }
+    return 0;
+}
+
+int is_valid_capacity(int capacity) {
+    return (capacity == 10000 || capacity == 100000 || capacity == 1000000);
+}
+
+/* 稀疏Pareto动态规划法最坏的结点数：生成的物品重量不超过 100，状态数不超过 min(C, 100n)+1 */
+long long pareto_worst_cells(int n, int capacity) {
+    long long states = 100LL * n < capacity ? 100LL * n : capacity;
+    return (long long)n * (states + 1);
+}
+
+/* 算法可行性检查 */
+void check_algorithm_feasibility(int n, int capacity) {
+    printf("\n============ 算法可行性分析 ============\n");
+    
+    /* 贪心法 - 总是可行 */
+    printf("✓ 贪心法: 可行 (时间复杂度: O(n log n))\n");
+    printf("✓ 线性时间贪心法: 可行 (时间复杂度: 期望 O(n)，结果不低于最优值的一半)\n");
+    printf("✓ FPTAS近似法: 可行 (时间复杂度: O(n log n + 大物品数/ε²)，与 C 无关，结果不低于 (1-ε)×最优值)\n");
+    
+    /* 动态规划法 */
+    long long dp_complexity = (long long)n * capacity;
+    if (dp_complexity <= 400000000LL) {  /* 4亿的阈值 */
+        printf("✓ 动态规划法: 可行 (时间复杂度: O(n×C) = %lld)\n", dp_complexity);
+    } else {
+        printf("✗ 动态规划法: 不可行 (时间复杂度过高: %lld > 4亿)\n", dp_complexity);
+    }
+
+    /* 线性空间动态规划法 - 内存只与C有关 */
+    printf("✓ 线性空间动态规划法: 可行 (时间复杂度: O(n×C)，约为动态规划法的2倍，内存约 %.1f MB)\n",
+           2.0 * (capacity + 1) * sizeof(value_t) / (1024.0 * 1024.0));
+    
+    /* 剪枝动态规划法 - 只计算能超过贪心下界的容量窗口 */
+    printf("✓ 剪枝动态规划法: 可行 (最坏 O(n×C)，随机实例每行的容量窗口通常远小于 C)\n");
+    
+    /* 稀疏Pareto动态规划法 - 状态数不超过 min(C, 物品总重)+1 */
+    if (pareto_worst_cells(n, capacity) <= 400000000LL) {
+        printf("✓ 稀疏Pareto动态规划法: 可行 (O(n×非支配状态数)，与 C 无关)\n");
+    } else {
+        printf("? 稀疏Pareto动态规划法: 状态数可能很多 (最坏 %lld 个父指针结点)，超过上限时自动报告\n",
+               pareto_worst_cells(n, capacity));
+    }
+    
+    /* 位集子集和法 - 每个物品一次移位或 */
+    printf("✓ 位集子集和法: 可行 (O(n×C/64)，只求可达重量，价值与重量成正比时为最优解)\n");
+    
+    /* 重量分组法 - 物品重量只有1-100，分组数与N无关 */
+    printf("✓ 重量分组法: 可行 (至多100个重量分组，时间复杂度: O(100×C log C)，选择表约 %.1f MB)\n",
+           100.0 * (capacity + 1) * sizeof(unsigned short) / (1024.0 * 1024.0));
+    
+    /* 核心法 */
+    printf("✓ 核心法: 可行 (随机实例的核心通常只有数百个物品，最坏情况退化为 O(n×C))\n");
+    
+    /* 回溯法 */
+    if (n <= 25) {
+        printf("✓ 回溯法: 可行 (但可能较慢)\n");
+    } else {
+        printf("✗ 回溯法: 不可行 (N=%d > 25, 时间复杂度: O(2^%d))\n", n, n);
+    }
+    
+    /* 并行回溯法 - 不限N，耗时取决于剪枝效果，超过结点上限时放弃 */
+    printf("✓ 并行回溯法: 可行，耗时取决于剪枝效果 (%d 个线程；随机实例通常很快，强相关等难实例可能指数时间，"
+           "访问结点超过 %lld 个时放弃)\n", dp_threads, console_bb_node_limit);
+    
+    /* 蛮力法 */
+    if (n <= 30) {
+        printf("✓ 蛮力法: 可行 (格雷码枚举，但会很慢)\n");
+    } else {
+        printf("✗ 蛮力法: 不可行 (N=%d > 30, 需要检查 2^%d 种组合)\n", n, n);
+    }
+    
+    /* 并行蛮力法 */
+    if (n <= 36) {
+        printf("✓ 并行蛮力法: 可行 (%d 个线程，向量化按块检查 2^%d 种组合)\n", dp_threads, n);
+    } else {
+        printf("✗ 并行蛮力法: 不可行 (N=%d > 36, 需要检查 2^%d 种组合)\n", n, n);
+    }
+    
+    /* 折半搜索法 */
+    if (n <= 60) {
+        printf("✓ 折半搜索法: 可行 (两半各 2^%d 个子集，去掉被支配项后不超过 C+1 个)\n", (n + 1) / 2);
+    } else {
+        printf("✗ 折半搜索法: 不可行 (N=%d > 60)\n", n);
+    }
+    
+    printf("========================================\n\n");
+}
+
+/* 主函数：不带参数时为交互菜单，带参数时为批量测试（见 batch_main） */
+int main(int argc, char* argv[]) {
+    int n, capacity, choice;
+    Item* items = NULL;
+    double program_start, program_end;
+    char csv_filename[100];
+    char student_info[100];
+    const char* seed_env = getenv("KNAPSACK_SEED");
+    unsigned long long seed = seed_env ? strtoull(seed_env, NULL, 10) : (unsigned long long)time(NULL);
+    
+    printf("价值类型: %s\n", VALUE_TYPE_NAME);
+    const char* kernel_name = dp_kernel_init();
+    printf("DP行内核: %s\n", kernel_name);
+    run_record_kernel = kernel_name;
+    run_record_path = getenv("KNAPSACK_RUN_LOG");
+    console_perf = getenv("KNAPSACK_PERF") ? atoi(getenv("KNAPSACK_PERF")) : 0;
+    if (getenv("KNAPSACK_BB_NODES")) {
+        console_bb_node_limit = atoll(getenv("KNAPSACK_BB_NODES"));
+    }
+    printf("蛮力法掩码内核: %s\n", mask_block_init());
+    printf("DP填表线程数: %d (可通过环境变量 KNAPSACK_THREADS 设置)\n", dp_threads_init());
+    {
+        int cached = planner_calibrate(kernel_name);
+        printf("规划器标定%s: DP %.3f ns/单元格，分组合并 %.2f ns/容量单元，排序 %.2f ns/次，内存带宽 %.1f GB/s\n",
+               cached ? "（读取缓存）" : "", planner_calibration.dp_ns, planner_calibration.wc_ns,
+               planner_calibration.sort_ns, planner_calibration.bandwidth);
+    }
+    if (argc > 1) {
+        return batch_main(argc, argv, kernel_name);
+    }
+    
+    #if defined(_WIN32) || defined(_WIN64)
+    SetConsoleOutputCP(65001);
+    #endif
+
+    // 获取学生信息用于文件名
+    printf("请输入学号-姓名 (例如: 20231060000-张三): ");
+    scanf("%s", student_info);
+    sprintf(csv_filename, "%s-数据.csv", student_info);
+    
+    // 初始化CSV文件，写入表头
+    FILE* fp = fopen(csv_filename, "w");
+    if (fp) {
+        fprintf(fp, "0-1背包问题实验数据\n\n");
+        fclose(fp);
+    } else {
+        printf("无法创建CSV文件: %s\n", csv_filename);
+        return 1;
+    }
+
+    while (1) {
+        show_menu();
+        
+        /* 输入物品数量 */
+        printf("请输入物品数量 (输入0退出): ");
+        if (scanf("%d", &n) != 1) {
+            printf("输入无效，请重新输入。\n");
+            while (getchar() != '\n');  /* 清空输入缓冲区 */
+            continue;
+        }
+        
+        if (n == 0) {
+            printf("程序退出。\n");
+            break;
+        }
+        
+        if (!is_valid_n(n)) {
+            printf("无效的物品数量！请选择支持的数量。\n");
+            continue;
+        }
+        
+        /* 输入背包容量 */
+        printf("请输入背包容量: ");
+        if (scanf("%d", &capacity) != 1) {
+            printf("输入无效，请重新输入。\n");
+            while (getchar() != '\n');
+            continue;
+        }
+        
+        if (!is_valid_capacity(capacity)) {
+            printf("无效的背包容量！请选择: 10000, 100000, 或 1000000。\n");
+            continue;
+        }
+        
+        /* 生成物品数据 */
+        printf("\n正在为 N=%d, C=%d 生成测试数据...\n", n, capacity);
+        items = (Item*)malloc(n * sizeof(Item));
+        if (!items) {
+            printf("内存分配失败！\n");
+            continue;
+        }
+        
+        /* 每轮换一个种子；设置环境变量 KNAPSACK_SEED 可以重现同样的各轮实例 */
+        generate_items(items, n, seed++, KNAPSACK_GEN_UNCORRELATED);
+        if (!values_fit_value_type(items, n)) {
+            printf("物品总价值超出 %s 的表示范围，请使用 -DKNAPSACK_VALUE_INT64 重新编译。\n", VALUE_TYPE_NAME);
+            free(items);
+            continue;
+        }
+        
+        /* 分析算法可行性 */
+        check_algorithm_feasibility(n, capacity);
+        
+        /* 记录程序开始时间（不包含数据生成时间） */
+        program_start = wall_time_ms();
+        
+        /* 选择要运行的算法 */
+        printf("请选择要运行的算法:\n");
+        printf("1. 贪心法\n");
+        printf("2. 动态规划法\n");
+        printf("3. 回溯法\n");
+        printf("4. 蛮力法\n");
+        printf("5. 运行所有可行的算法\n");
+        printf("6. 线性空间动态规划法\n");
+        printf("7. 重量分组法\n");
+        printf("8. 核心法\n");
+        printf("9. 并行回溯法\n");
+        printf("10. 折半搜索法\n");
+        printf("11. 并行蛮力法\n");
+        printf("12. 线性时间贪心法\n");
+        printf("13. FPTAS近似法\n");
+        printf("14. 自动选择（按标定的代价模型和预算）\n");
+        printf("15. 剪枝动态规划法\n");
+        printf("16. 稀疏Pareto动态规划法\n");
+        printf("17. 位集子集和法（可达重量分析）\n");
+        printf("选择 (1-17): ");
+        
+        if (scanf("%d", &choice) != 1) {
+            printf("输入无效。\n");
+            free(items);
+            while (getchar() != '\n');
+            continue;
+        }
+        
+        printf("\n开始算法测试...\n");
+        printf("======================================\n");
+        
+        switch (choice) {
+            case 1:
+                greedy_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 2:
+                if ((long long)n * capacity <= 400000000LL) {
+                    dynamic_programming_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("动态规划法: 问题规模过大，改用 FPTAS 近似法（ε = 0.001，也可选择 6 使用线性空间动态规划法）。\n");
+                    fptas_knapsack(items, n, capacity, 0.001, csv_filename);
+                }
+                break;
+                
+            case 3:
+                if (n <= 25) {
+                    backtracking_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("回溯法: N=%d 过大，跳过执行。\n", n);
+                }
+                break;
+                
+            case 4:
+                if (n <= 30) {
+                    brute_force_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("蛮力法: N=%d 过大，跳过执行。\n", n);
+                }
+                break;
+                
+            case 5:
+                /* 贪心法 */
+                greedy_knapsack(items, n, capacity, csv_filename);
+                linear_greedy_knapsack(items, n, capacity, csv_filename);
+                
+                /* 动态规划法 */
+                if ((long long)n * capacity <= 400000000LL) {
+                    dynamic_programming_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("动态规划法: 问题规模过大，改用线性空间动态规划法。\n\n");
+                    linear_space_dp_knapsack(items, n, capacity, csv_filename);
+                }
+                pruned_dp_knapsack(items, n, capacity, csv_filename);
+                
+                /* 稀疏Pareto动态规划法 */
+                if (pareto_worst_cells(n, capacity) <= 400000000LL) {
+                    pareto_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("稀疏Pareto动态规划法: 非支配状态可能过多，跳过执行。\n\n");
+                }
+                
+                /* 位集子集和法 */
+                reachable_knapsack(items, n, capacity, csv_filename);
+                
+                /* FPTAS近似法 */
+                fptas_knapsack(items, n, capacity, 0.01, csv_filename);
+                
+                /* 重量分组法 */
+                weight_class_knapsack(items, n, capacity, csv_filename);
+                
+                /* 核心法 */
+                core_knapsack(items, n, capacity, csv_filename);
+                
+                /* 回溯法 */
+                if (n <= 25) {
+                    backtracking_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("回溯法: N=%d 过大，跳过执行。\n\n", n);
+                }
+                
+                /* 并行回溯法（不限N，超过结点上限时放弃） */
+                parallel_backtracking_knapsack(items, n, capacity, csv_filename);
+                
+                /* 蛮力法 */
+                if (n <= 30) {
+                    brute_force_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("蛮力法: N=%d 过大，跳过执行。\n\n", n);
+                }
+                
+                /* 并行蛮力法 */
+                if (n <= 36) {
+                    parallel_brute_force_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("并行蛮力法: N=%d 过大，跳过执行。\n\n", n);
+                }
+                
+                /* 折半搜索法 */
+                if (n <= 60) {
+                    meet_in_middle_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("折半搜索法: N=%d 过大，跳过执行。\n\n", n);
+                }
+                break;
+                
+            case 6:
+                linear_space_dp_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 7:
+                weight_class_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 8:
+                core_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 9:
+                parallel_backtracking_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 10:
+                if (n <= 60) {
+                    meet_in_middle_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("折半搜索法: N=%d 过大，跳过执行。\n", n);
+                }
+                break;
+                
+            case 11:
+                if (n <= 36) {
+                    parallel_brute_force_knapsack(items, n, capacity, csv_filename);
+                } else {
+                    printf("并行蛮力法: N=%d 过大，跳过执行。\n", n);
+                }
+                break;
+                
+            case 12:
+                linear_greedy_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 13: {
+                double epsilon;
+                printf("请输入近似误差 ε (0.001-0.5): ");
+                if (scanf("%lf", &epsilon) != 1 || epsilon < 0.001 || epsilon > 0.5) {
+                    printf("输入无效，使用 ε = 0.01。\n");
+                    while (getchar() != '\n');
+                    epsilon = 0.01;
+                }
+                fptas_knapsack(items, n, capacity, epsilon, csv_filename);
+                break;
+            }
+                
+            case 14:
+                auto_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 15:
+                pruned_dp_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 16:
+                pareto_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+            case 17:
+                reachable_knapsack(items, n, capacity, csv_filename);
+                break;
+                
+                
+            default:
+                printf("无效选择。\n");
+                break;
+        }
+        
+        /* 记录程序结束时间 */
+        program_end = wall_time_ms();
+        double total_execution_time = program_end - program_start;
+        
+        printf("======================================\n");
+        printf("程序总执行时间: %.2f ms\n", total_execution_time);
+        printf("======================================\n\n");
+        
+        free(items);
+        
+        /* 询问是否继续 */
+        printf("是否继续测试其他配置? (y/n): ");
+        char continue_choice;
+        scanf(" %c", &continue_choice);
+        if (continue_choice != 'y' && continue_choice != 'Y') {
+            break;
+        }
+    }
+    
+    printf("测试完成！数据已保存至: %s\n", csv_filename);
+    printf("该文件可以直接用Excel打开，或转换为xlsx格式。\n");
+    return 0;
+}
+
+#endif /* KNAPSACK_NO_MAIN */
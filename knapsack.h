@@ -0,0 +1,385 @@
+/*
+ * knapsack.h
+ * 0-1背包求解器的库接口，可以不经过菜单直接嵌入其他程序。
+ *
+ * 用法：把 0_1backpage.c 加上 -DKNAPSACK_NO_MAIN 编译进自己的程序（不含菜单、批量测试和 main），
+ * 每个线程持有一个 KnapsackSolver，反复调用 knapsack_solve()：
+ *
+ *     KnapsackSolver solver;
+ *     KnapsackResult result;
+ *     knapsack_solver_init(&solver);
+ *     if (knapsack_solve(&solver, items, n, C, KNAPSACK_ALGO_CORE, &result) == KNAPSACK_OK) {
+ *         ... result.total_value, result.selection[i] ...
+ *     }
+ *     knapsack_solver_free(&solver);
+ *
+ * items[i].id 必须为 i+1（generate_items 生成的物品即如此），求解器按 id 写回选择数组。
+ * 求解器内部不做任何输入输出。排序副本、选择数组、DP行等临时内存都从求解器的内存池中分配，
+ * 每次求解开始时整体回收；内存池按历史峰值一次性扩容，规模稳定后求解过程不再调用 malloc。
+ * 同一个 KnapsackSolver 不能被多个线程同时使用。
+ */
+#ifndef KNAPSACK_H
+#define KNAPSACK_H
+
+#include <stddef.h>
+#include <limits.h>
+#include <float.h>
+
+/*
+ * 物品价值的表示方式（编译时选择）:
+ *   默认                    double，单位为元
+ *   -DKNAPSACK_VALUE_INT32  int，单位为分，DP行只占double的一半
+ *   -DKNAPSACK_VALUE_INT64  long long，单位为分
+ * 整数表示下加法和比较都是精确的，不同算法的结果可以直接用 == 比较。
+ */
+#if defined(KNAPSACK_VALUE_INT32)
+typedef int value_t;
+#define VALUE_MAX INT_MAX
+#define VALUE_CENTS_MAX INT_MAX         /* 能转换为 value_t 的最大价值（分） */
+#define VALUE_FROM_CENTS(c) ((value_t)(c))
+#define VALUE_TO_DOUBLE(v) ((double)(v) / 100.0)
+#define VALUE_TO_CENTS(v) ((long long)(v))
+#define VALUE_TYPE_NAME "int32 (分)"
+#define VALUE_IS_INTEGER 1
+#elif defined(KNAPSACK_VALUE_INT64)
+typedef long long value_t;
+#define VALUE_MAX LLONG_MAX
+#define VALUE_CENTS_MAX LLONG_MAX
+#define VALUE_FROM_CENTS(c) ((value_t)(c))
+#define VALUE_TO_DOUBLE(v) ((double)(v) / 100.0)
+#define VALUE_TO_CENTS(v) ((long long)(v))
+#define VALUE_TYPE_NAME "int64 (分)"
+#define VALUE_IS_INTEGER 1
+#else
+typedef double value_t;
+#define VALUE_MAX DBL_MAX
+#define VALUE_CENTS_MAX LLONG_MAX
+#define VALUE_FROM_CENTS(c) ((c) / 100.0)
+#define VALUE_TO_DOUBLE(v) ((double)(v))
+#define VALUE_TO_CENTS(v) llround((v) * 100.0)
+#define VALUE_TYPE_NAME "double (元)"
+#define VALUE_IS_INTEGER 0
+#endif
+
+/*
+ * 求解器内部按列存储物品时重量的类型（编译时选择）:
+ *   默认                    int
+ *   -DKNAPSACK_WEIGHT_U16   unsigned short，重量不超过 65535
+ *   -DKNAPSACK_WEIGHT_U8    unsigned char，重量不超过 255（随机物品的重量为1-100）
+ * 重量超过 C 的物品不可能被选中，不进入列中，所以 C 不超过 WEIGHT_MAX 时任何实例都可以求解；
+ * 否则遇到放不下的重量时 knapsack_solve() 返回 KNAPSACK_ERR_TOO_LARGE。
+ */
+#if defined(KNAPSACK_WEIGHT_U8)
+typedef unsigned char weight_t;
+#define WEIGHT_MAX UCHAR_MAX
+#elif defined(KNAPSACK_WEIGHT_U16)
+typedef unsigned short weight_t;
+#define WEIGHT_MAX USHRT_MAX
+#else
+typedef int weight_t;
+#define WEIGHT_MAX INT_MAX
+#endif
+
+typedef struct {
+    int id;
+    int weight;
+    value_t value;
+    double density;  /* value / weight，与 value 同单位 */
+} Item;
+
+/*
+ * 内存池：一整块连续内存顺序分配（64字节对齐），放不下时临时 malloc 溢出块。
+ * knapsack_arena_reset() 释放溢出块，并把主块扩大到本轮的峰值（不超过 retain_limit），
+ * 因此同样规模的下一轮全部在主块内完成。
+ */
+typedef struct KnapsackArenaChunk KnapsackArenaChunk;
+
+typedef struct {
+    unsigned char* base;
+    size_t capacity;
+    size_t used;
+    size_t overflow_bytes;      /* 本轮溢出块的总大小 */
+    size_t peak;                /* 本轮 used + overflow_bytes 的最大值 */
+    size_t retain_limit;        /* 主块最多保留的字节数，超过的峰值每次都走溢出块 */
+    KnapsackArenaChunk* overflow;
+} KnapsackArena;
+
+#define KNAPSACK_ARENA_RETAIN ((size_t)256 << 20)
+
+void knapsack_arena_init(KnapsackArena* arena);
+void* knapsack_arena_alloc(KnapsackArena* arena, size_t bytes);
+void* knapsack_arena_calloc(KnapsackArena* arena, size_t count, size_t size);
+void knapsack_arena_reset(KnapsackArena* arena);
+void knapsack_arena_free(KnapsackArena* arena);
+
+/* 库接口支持的算法 */
+typedef enum {
+    KNAPSACK_ALGO_GREEDY,
+    KNAPSACK_ALGO_LINEAR_GREEDY,
+    KNAPSACK_ALGO_FPTAS,
+    KNAPSACK_ALGO_DP,
+    KNAPSACK_ALGO_LINEAR_DP,
+    KNAPSACK_ALGO_WEIGHT_CLASS,
+    KNAPSACK_ALGO_CORE,
+    KNAPSACK_ALGO_BRANCH_BOUND,
+    KNAPSACK_ALGO_BRUTE_FORCE,
+    KNAPSACK_ALGO_PARALLEL_BRUTE_FORCE,
+    KNAPSACK_ALGO_MEET_IN_MIDDLE,
+    KNAPSACK_ALGO_PRUNED_DP,
+    KNAPSACK_ALGO_PARETO_DP,
+    KNAPSACK_ALGO_PARALLEL_BRANCH_BOUND,  /* 并行回溯法：线程数与DP填表相同（环境变量 KNAPSACK_THREADS），任务队列不在内存池中 */
+    KNAPSACK_ALGO_MAX_WEIGHT,   /* 位集子集和法：选出总重量为不超过 C 的最大可达重量的子集，不考虑价值，不是价值最优解 */
+    KNAPSACK_ALGO_COUNT
+} KnapsackAlgorithm;
+
+/* knapsack_solve() 的返回值 */
+#define KNAPSACK_OK 0
+#define KNAPSACK_ERR_NOMEM 1        /* 内存不足 */
+#define KNAPSACK_ERR_TOO_LARGE 2    /* 超出该算法的规模限制（蛮力法、折半搜索法、Pareto状态数、并行回溯法的结点上限），或重量超出 weight_t */
+#define KNAPSACK_ERR_INVALID 3      /* 参数无效 */
+#define KNAPSACK_ERR_IO 4           /* 物品文件读写失败或格式不符 */
+
+/* 求解过程的阶段，knapsack_solve() 按阶段累计墙钟时间 */
+typedef enum {
+    KNAPSACK_PHASE_ALLOC,       /* 分配：内存池、选择数组、DP表和工作行 */
+    KNAPSACK_PHASE_SORT,        /* 排序：取出放得下的物品并按密度或重量排序 */
+    KNAPSACK_PHASE_FILL,        /* 填表：DP填表、搜索、枚举等主循环（含位集预处理） */
+    KNAPSACK_PHASE_RECONSTRUCT, /* 重构：回溯出选择并累计总价值、总重量 */
+    KNAPSACK_PHASE_OUTPUT,      /* 输出：打印结果、写CSV，由控制台程序计时 */
+    KNAPSACK_PHASE_COUNT
+} KnapsackPhase;
+
+typedef struct {
+    int status;
+    value_t total_value;
+    long long total_weight;
+    int selected_count;
+    int* selection;             /* selection[i] 为 1 表示选取 items[i]；属于求解器，下次求解前有效 */
+
+    /* 各算法的统计信息，未用到的为 0 */
+    int break_item;             /* 核心法：断点物品在密度序中的位置；线性时间贪心法：断点物品编号 */
+    double upper_bound;         /* 线性时间贪心法、剪枝动态规划法：分数上界 */
+    int single_item;            /* 线性时间贪心法：为1表示最大单件物品优于贪心解 */
+    double lower_bound;         /* FPTAS、剪枝动态规划法：贪心下界 */
+    double epsilon;             /* FPTAS：实际使用的 ε（内存不够时会放宽） */
+    int large_items;            /* FPTAS：大物品数 */
+    int kept_items;             /* FPTAS：约简后的大物品数 */
+    int small_items;            /* FPTAS：小物品数 */
+    int value_states;           /* FPTAS：价值状态数（物品不超过32个时直接求精确解，大小物品数和状态数都为0） */
+    int sorted_items;           /* 线性时间贪心法：断点后参与排序的物品数 */
+    int classes;                /* 重量分组法：分组数 */
+    int class_segment;          /* 重量分组法：每段的分组数，等于分组数时选择表全部保存，否则只保存一段，其余段回溯时从检查点重算 */
+    int core_start;             /* 核心法：最终核心 [core_start, core_end) */
+    int core_end;
+    int rounds;                 /* 核心法：扩展轮数 */
+    long long nodes;            /* 回溯法、并行回溯法：访问的结点数 */
+    long long pruned;           /* 回溯法、并行回溯法：剪枝的结点数 */
+    long long steals;           /* 并行回溯法：从其他线程窃取任务的次数 */
+    long long masks;            /* 蛮力法、并行蛮力法：检查的子集掩码数（并行蛮力法不含整块超重跳过的） */
+    int subsets_left;           /* 折半搜索法：两半不被支配的子集数 */
+    int subsets_right;
+    int rows_filled;            /* 剪枝动态规划法：实际填写的行数，之后的行因窗口为空提前结束 */
+    long long cells_computed;   /* 动态规划法、线性空间动态规划法、剪枝动态规划法：计算的格子数 */
+    long long cells_skipped;    /* 动态规划法、剪枝动态规划法：n×(C+1) 中跳过的格子数（含位集预处理收紧的容量） */
+    int frontier_max;           /* 稀疏Pareto动态规划法：非支配状态表的最大长度 */
+    long long frontier_nodes;   /* 稀疏Pareto动态规划法：父指针结点数 */
+    int reachable;              /* 位集子集和法：[0, C] 中可达重量的个数（含 0） */
+    int capacity_bound;         /* 实际使用的容量：动态规划法、线性空间动态规划法经位集预处理收紧为不超过 C 的最大可达重量，其他算法为 C */
+
+    /* 计时和硬件计数，所有算法都有 */
+    double phase_ms[KNAPSACK_PHASE_COUNT];  /* 各阶段的墙钟时间（毫秒），OUTPUT 由调用方自己计入 */
+    long long perf_cycles;      /* solver->perf 非0时的CPU周期、指令、缓存未命中数（只统计调用线程，多线程算法中其他线程的工作不计入），不可用时为 -1 */
+    long long perf_instructions;
+    long long perf_cache_misses;
+} KnapsackResult;
+
+/*
+ * 物品文件：64字节文件头之后是两列定长数组（本机字节序，各列起点64字节对齐）：
+ *   int       weight[n]        重量
+ *   long long value_cents[n]   价值，单位为分（与 value_t 的选择无关，整数表示精确）
+ * knapsack_item_file_open() 用 mmap 只读映射整个文件，只检查文件头，打开耗时与 n 无关；
+ * weight / value_cents 指向映射的列，在 knapsack_item_file_close() 之前有效。
+ * 只经过排序列的求解器（贪心法、FPTAS近似法、重量分组法、核心法、回溯法、并行回溯法、剪枝动态规划法）
+ * 可以用 knapsack_solve_file() 直接从映射的两列建排序列，不需要 Item 数组；
+ * 其余算法要先用 knapsack_item_file_items() 把两列展开为 Item 数组（顺序扫描，耗时与 n 成正比）。
+ */
+#define KNAPSACK_ITEM_FILE_MAGIC "KPITEMS"
+#define KNAPSACK_ITEM_FILE_VERSION 1
+
+typedef struct {
+    char magic[8];              /* KNAPSACK_ITEM_FILE_MAGIC，以 '\0' 结尾 */
+    int version;
+    int weight_bytes;           /* 4 */
+    long long n;
+    int value_bytes;            /* 8 */
+    int max_weight;
+    long long weight_offset;    /* 从文件开头算起 */
+    long long value_offset;
+    char reserved[16];
+} KnapsackItemFileHeader;
+
+typedef struct {
+    int n;
+    int max_weight;
+    const int* weight;
+    const long long* value_cents;
+    void* map;                  /* 映射的起点和长度 */
+    size_t map_size;
+    void* mapping;              /* Windows 的映射对象句柄 */
+} KnapsackItemFile;
+
+int knapsack_item_file_open(KnapsackItemFile* file, const char* path);
+void knapsack_item_file_close(KnapsackItemFile* file);
+/*
+ * 把 [0, n) 号物品展开为 Item 数组（编号 i+1、价值换算为 value_t、计算密度），
+ * 重量不为正、价值为负或超出 VALUE_CENTS_MAX 时返回 KNAPSACK_ERR_INVALID
+ */
+int knapsack_item_file_items(const KnapsackItemFile* file, Item* items);
+int knapsack_item_file_write(const char* path, const Item* items, int n);
+/*
+ * 逐行导入文本文件：每行"重量,价值"或"编号,重量,价值"（编号忽略），价值以元为单位；不以数字或负号开头的行视为表头跳过。
+ * 行超过511字节、数值为负、格式不符或价值超出 VALUE_CENTS_MAX 时返回 KNAPSACK_ERR_INVALID，读写失败返回 KNAPSACK_ERR_IO；
+ * 失败时不留下输出文件，*imported 为出错的行号（读写失败时为0）。
+ */
+int knapsack_item_file_import_csv(const char* csv_path, const char* path, int* imported);
+
+/*
+ * 随机实例：物品 i 只由 (seed, i) 决定（Philox4x32-10 计数器发生器），按下标并行填充，
+ * 任何机器、线程数和C库下同一种子生成的实例逐位相同。重量均为 1-100，价值精确到分。
+ * 除不相关实例外都是 Pisinger 的经典难实例族（R=100，价值按每单位重量10元缩放）。
+ */
+typedef enum {
+    KNAPSACK_GEN_UNCORRELATED,            /* 价值 100.00-1000.00 元，与重量无关 */
+    KNAPSACK_GEN_WEAKLY_CORRELATED,       /* 价值在 10×重量 ± 100 元之间（不低于10元） */
+    KNAPSACK_GEN_STRONGLY_CORRELATED,     /* 价值 = 10×(重量+10) 元 */
+    KNAPSACK_GEN_INVERSE_STRONGLY_CORRELATED, /* 价值 10-900 元，重量 = 价值/10 + 10 */
+    KNAPSACK_GEN_ALMOST_STRONGLY_CORRELATED,  /* 价值在 10×(重量+10) ± 2 元之间 */
+    KNAPSACK_GEN_SUBSET_SUM,              /* 价值 = 10×重量 元，所有物品密度相同 */
+    KNAPSACK_GEN_COUNT
+} KnapsackInstanceFamily;
+
+/* 生成 n 个物品（编号 i+1），family 无效时返回 KNAPSACK_ERR_INVALID */
+int knapsack_generate(Item* items, int n, unsigned long long seed, KnapsackInstanceFamily family);
+
+/* 进度回调：done / total 为已完成的工作量，控制台程序用它显示进度 */
+typedef void (*knapsack_progress_fn)(void* user, long long done, long long total);
+
+typedef struct {
+    KnapsackArena arena;
+    double epsilon;             /* FPTAS 的 ε，默认 0.001 */
+    int reach_prepass;          /* 非0时（默认）动态规划法、线性空间动态规划法先求可达重量，把容量收紧到最大可达重量 */
+    int perf;                   /* 非0时用 perf_event_open 统计硬件计数（仅Linux），默认 0 */
+    long long node_limit;       /* 并行回溯法访问结点数的上限，0（默认）表示不限；超出时放弃搜索，返回 KNAPSACK_ERR_TOO_LARGE */
+    int phase;                  /* 内部：当前阶段及其开始时间 */
+    double phase_start;
+    const KnapsackItemFile* file;   /* 内部：knapsack_solve_file() 求解期间指向物品文件 */
+    knapsack_progress_fn progress;
+    void* progress_user;
+} KnapsackSolver;
+
+void knapsack_solver_init(KnapsackSolver* solver);
+void knapsack_solver_free(KnapsackSolver* solver);
+
+/* 求解一次，返回 KNAPSACK_OK 或错误码（同时写入 result->status） */
+int knapsack_solve(KnapsackSolver* solver, const Item* items, int n, int C,
+                   KnapsackAlgorithm algo, KnapsackResult* result);
+
+/*
+ * 直接在映射的物品文件上求解（file 的 n 个物品，selection 按文件中的顺序），只支持上面列出的
+ * 列式求解器，其余算法返回 KNAPSACK_ERR_INVALID；物品重量不为正、价值为负或超出 VALUE_CENTS_MAX 时同样返回 KNAPSACK_ERR_INVALID。
+ */
+int knapsack_solve_file(KnapsackSolver* solver, const KnapsackItemFile* file, int C,
+                        KnapsackAlgorithm algo, KnapsackResult* result);
+
+/*
+ * 多容量查询：同一组物品对多个容量求最优值时，DP 只需填到最大容量一次，
+ * 最后一行就是所有容量 0..max_capacity 的答案；每个容量的选择按需重构。
+ *
+ *     KnapsackCapacityTable table;
+ *     knapsack_capacity_table_build(&solver, items, n, max_c, &table);
+ *     ... table.best[c] ...
+ *     knapsack_capacity_table_select(&table, c, selection);   selection 为调用方的 n 个 int
+ *
+ * 表的内存来自求解器的内存池，在同一求解器下一次求解或建表之前有效。
+ * 除最后一行外只保存每个物品一行按位打包的选取标记，约 n×(max_capacity+1)/8 字节。
+ */
+typedef struct {
+    int n;
+    int max_capacity;
+    const Item* items;          /* 建表时的物品，重构时读取重量 */
+    const value_t* best;        /* best[c] 为容量不超过 c 时的最优值，随 c 单调不减 */
+    unsigned char** keep;       /* keep[i] 的第 c 位为 1 表示容量 c 时选取 items[i]（只考虑前 i+1 个物品） */
+} KnapsackCapacityTable;
+
+int knapsack_capacity_table_build(KnapsackSolver* solver, const Item* items, int n, int max_capacity,
+                                  KnapsackCapacityTable* table);
+/* 重构容量 capacity 的最优选择写入 selection[0..n)，容量超出 [0, max_capacity] 时返回 KNAPSACK_ERR_INVALID */
+int knapsack_capacity_table_select(const KnapsackCapacityTable* table, int capacity, int* selection);
+
+/*
+ * 增量DP：物品集合逐个增删时保留DP状态，不再每次从第0行重建。
+ * 状态包括前沿行（当前全部物品的DP最后一行）、每 KNAPSACK_INCREMENTAL_CHECKPOINT 个物品一条检查点行，
+ * 以及每个物品一行按位打包的选取标记。增删只做记录，knapsack_incremental_solve() 时统一重算：
+ *   追加物品：从前沿行接着算，每个新物品一行，O(C)；
+ *   删除第 k 个物品：从 k 之前最近的检查点重算到末尾，O((n-k+间隔)×C)，几次删除合并为一次重算。
+ * 刷新的代价取决于删除的位置：删除较新的物品很快，随机位置平均要重算约 n/2 行，删除最早的物品与重建相当。
+ * 只求最优值时可以另存后缀行，用 max{前缀行[c] + 后缀行[C-c]} 以 O(C) 合并；但每次追加都会使全部后缀行失效，
+ * 重构选择又要后缀一侧逐个物品的选取标记，在"删一个、加一个"的更新下并不比从检查点重算省，所以没有采用。
+ * 状态自己管理内存，与求解器无关，可以长期保留。
+ */
+#define KNAPSACK_INCREMENTAL_CHECKPOINT 64
+
+typedef struct {
+    int C;
+    int n;
+    int max_items;              /* items / keep / checkpoints 已分配的物品数 */
+    Item* items;                /* 当前物品（按追加顺序，删除时后面的前移），id 由调用方指定，用于删除 */
+    int valid;                  /* items[0..valid) 的选取标记和检查点仍然有效 */
+    int frontier_items;         /* 前沿行对应前几个物品，-1 表示前沿行已失效（其中有被删除的物品） */
+    value_t* rows[2];           /* 交替使用的两条工作行，前沿行为 rows[frontier] */
+    int frontier;
+    value_t* checkpoints;       /* 第 j 条（C+1 个值）为前 j×KNAPSACK_INCREMENTAL_CHECKPOINT 个物品的DP行 */
+    unsigned char* keep;        /* 第 i 个物品的选取标记从 keep + i×keep_bytes 开始 */
+    size_t keep_bytes;
+    int* selection;             /* knapsack_incremental_solve() 写入的选择，对应 items[i] */
+    long long rows_computed;    /* 统计：累计计算的DP行数 */
+} KnapsackIncremental;
+
+int knapsack_incremental_init(KnapsackIncremental* state, int C);
+void knapsack_incremental_free(KnapsackIncremental* state);
+int knapsack_incremental_append(KnapsackIncremental* state, const Item* item);
+/* 删除 id 为 id 的物品，不存在时返回 KNAPSACK_ERR_INVALID */
+int knapsack_incremental_remove(KnapsackIncremental* state, int id);
+/* 重算失效的行并重构选择；result->selection 指向 state->selection，下一次增删之前有效 */
+int knapsack_incremental_solve(KnapsackIncremental* state, KnapsackResult* result);
+
+/*
+ * 可达重量（子集和）：只关心哪些重量和能恰好凑出时不需要价值表，用位集代替DP行，
+ * 每个物品做一次 bits |= bits << w，共 O(n×C/64) 次字运算，内存 (C+1)/8 字节。
+ *
+ *     KnapsackReachable reach;
+ *     knapsack_reachable_build(&solver, items, n, C, 1, &reach);
+ *     ... KNAPSACK_REACHABLE(&reach, w)、reach.max_weight ...
+ *     knapsack_reachable_select(&reach, reach.max_weight, selection);   selection 为调用方的 n 个 int
+ *
+ * with_first 非0时另记每个重量第一次变为可达时加入的物品（C+1 个 int），才能重构子集。
+ * 内存来自求解器的内存池，在同一求解器下一次求解或建表之前有效。
+ */
+typedef struct {
+    int n;
+    int C;
+    const Item* items;
+    const unsigned long long* bits; /* 第 w 位为 1 表示存在重量和恰为 w 的子集，0 ≤ w ≤ C */
+    const int* first;           /* first[w]：使重量 w 第一次可达的物品下标（with_first 为 0 时为 NULL） */
+    int max_weight;             /* 不超过 C 的最大可达重量 */
+    int reachable;              /* 可达重量个数（含 0） */
+} KnapsackReachable;
+
+#define KNAPSACK_REACHABLE(reach, w) (((reach)->bits[(w) >> 6] >> ((w) & 63)) & 1)
+
+int knapsack_reachable_build(KnapsackSolver* solver, const Item* items, int n, int C, int with_first,
+                             KnapsackReachable* reach);
+/* 把恰好凑出重量 w 的一个子集写入 selection[0..n)；w 不可达或未记录 first 时返回 KNAPSACK_ERR_INVALID */
+int knapsack_reachable_select(const KnapsackReachable* reach, int w, int* selection);
+
+#endif /* KNAPSACK_H */
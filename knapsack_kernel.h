@@ -0,0 +1,579 @@
+/*
+ * knapsack_kernel.h
+ * 0-1背包DP的行更新内核，0_1backpage.c 和 out.c 共用。
+ *
+ * 提供 double / int / long long 三种价值类型的实现，调用方统一使用类型泛型的
+ * dp_row_kernel() / dp_row_update()，按行数组的元素类型自动选择。
+ *
+ * 一次行更新对容量区间 [lo, hi] 计算 cur[w] = max(prev[w], prev[w-wt] + v)，
+ * 并把"是否选取"的决定按位打包写入 keep（第 w 位为 1 表示选取，keep 可为 NULL）。
+ * 按容量从高到低处理，每个向量先读后写，因此整行更新时允许 prev == cur 原地更新。
+ * lo 和 hi+1 需是 DP_SLICE_ALIGN 的倍数（hi 为行末时除外），保证不同线程不会写同一个 keep 字节。
+ *
+ * 程序启动时调用 dp_kernel_init()，根据 cpuid 选择标量/SSE2/AVX2/AVX-512 实现；
+ * dp_threads_init() 决定按容量维度并行填表的线程数（编译时需 -fopenmp）；
+ * 保存整张DP表时可用 dp_tile_schedule() 按"物品块 × 容量段"分块填表。
+ * 按密度等键排序物品时用 radix_sort_keys() 只移动键和下标。
+ * 生成随机实例时用计数器随机数发生器 philox4x32()，结果只由种子和物品下标决定。
+ * 只关心哪些重量和可达（子集和）时，用位集内核 bitset_shift_or() 每次处理64个容量单元。
+ */
+#ifndef KNAPSACK_KERNEL_H
+#define KNAPSACK_KERNEL_H
+
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KNAPSACK_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+typedef void (*dp_row_f64_fn)(const double* prev, double* cur, unsigned char* keep, int lo, int hi, int wt, double v);
+typedef void (*dp_row_i32_fn)(const int* prev, int* cur, unsigned char* keep, int lo, int hi, int wt, int v);
+typedef void (*dp_row_i64_fn)(const long long* prev, long long* cur, unsigned char* keep, int lo, int hi, int wt, long long v);
+
+/* 打包选取位所需的字节数 */
+#define DP_KEEP_BYTES(C) ((size_t)(C) / 8 + 1)
+#define DP_KEEP_GET(keep, w) (((keep)[(w) >> 3] >> ((w) & 7)) & 1)
+
+/* 标量处理 [lo, hi] 区间（从高到低），向量内核用它处理首尾不对齐的部分 */
+static void dp_row_f64_range(const double* prev, double* cur, unsigned char* keep, int lo, int hi, int wt, double v) {
+    int w;
+    for (w = hi; w >= lo; w--) {
+        double taken = prev[w - wt] + v;
+        double not_taken = prev[w];
+        if (taken > not_taken) {
+            cur[w] = taken;
+            if (keep) keep[w >> 3] |= (unsigned char)(1 << (w & 7));
+        } else {
+            cur[w] = not_taken;
+        }
+    }
+}
+
+static void dp_row_i32_range(const int* prev, int* cur, unsigned char* keep, int lo, int hi, int wt, int v) {
+    int w;
+    for (w = hi; w >= lo; w--) {
+        int taken = prev[w - wt] + v;
+        int not_taken = prev[w];
+        if (taken > not_taken) {
+            cur[w] = taken;
+            if (keep) keep[w >> 3] |= (unsigned char)(1 << (w & 7));
+        } else {
+            cur[w] = not_taken;
+        }
+    }
+}
+
+static void dp_row_i64_range(const long long* prev, long long* cur, unsigned char* keep, int lo, int hi, int wt, long long v) {
+    int w;
+    for (w = hi; w >= lo; w--) {
+        long long taken = prev[w - wt] + v;
+        long long not_taken = prev[w];
+        if (taken > not_taken) {
+            cur[w] = taken;
+            if (keep) keep[w >> 3] |= (unsigned char)(1 << (w & 7));
+        } else {
+            cur[w] = not_taken;
+        }
+    }
+}
+
+/* 公共前处理：清空 [lo, hi] 的选取位，复制放不下当前物品的 [lo, wt) 部分，返回需要比较的起点 */
+static int dp_row_prologue(const void* prev, void* cur, unsigned char* keep, int lo, int hi, int wt, size_t elem) {
+    int low = wt > lo ? (wt <= hi ? wt : hi + 1) : lo;
+    if (keep) memset(keep + (lo >> 3), 0, (size_t)(hi >> 3) - (lo >> 3) + 1);
+    if (prev != cur && low > lo) {
+        memcpy((char*)cur + (size_t)lo * elem, (const char*)prev + (size_t)lo * elem, (size_t)(low - lo) * elem);
+    }
+    return low;
+}
+
+static void dp_row_f64_scalar(const double* prev, double* cur, unsigned char* keep, int lo, int hi, int wt, double v) {
+    int low = dp_row_prologue(prev, cur, keep, lo, hi, wt, sizeof(double));
+    if (low <= hi) dp_row_f64_range(prev, cur, keep, low, hi, wt, v);
+}
+
+static void dp_row_i32_scalar(const int* prev, int* cur, unsigned char* keep, int lo, int hi, int wt, int v) {
+    int low = dp_row_prologue(prev, cur, keep, lo, hi, wt, sizeof(int));
+    if (low <= hi) dp_row_i32_range(prev, cur, keep, low, hi, wt, v);
+}
+
+static void dp_row_i64_scalar(const long long* prev, long long* cur, unsigned char* keep, int lo, int hi, int wt, long long v) {
+    int low = dp_row_prologue(prev, cur, keep, lo, hi, wt, sizeof(long long));
+    if (low <= hi) dp_row_i64_range(prev, cur, keep, low, hi, wt, v);
+}
+
+/*
+ * 位集移位或：bits 的第 w 位表示重量和 w 可达，加入重量为 wt 的物品即 bits |= bits << wt。
+ * 只处理字下标 [lo, hi]（lo ≥ wt/64），从高到低，每个字只读比它低的字或自身，因此原地更新。
+ * first 不为 NULL 时，对新变为可达的每个重量 w 记 first[w] = item（first 至少有 (hi+1)×64 个元素）。
+ */
+typedef void (*bitset_shift_or_fn)(unsigned long long* bits, int lo, int hi, int wt, int* first, int item);
+
+static void bitset_record(unsigned long long fresh, int base, int* first, int item) {
+    while (fresh) {
+#if defined(__GNUC__)
+        first[base + __builtin_ctzll(fresh)] = item;
+#else
+        int k = 0;
+        while (!((fresh >> k) & 1)) k++;
+        first[base + k] = item;
+#endif
+        fresh &= fresh - 1;
+    }
+}
+
+static void bitset_shift_or_scalar(unsigned long long* bits, int lo, int hi, int wt, int* first, int item) {
+    int q = wt >> 6, r = wt & 63, i;
+    for (i = hi; i >= lo; i--) {
+        unsigned long long s = i - q >= 0 ? bits[i - q] << r : 0;
+        if (r && i - q - 1 >= 0) s |= bits[i - q - 1] >> (64 - r);
+        if (first) bitset_record(s & ~bits[i], i << 6, first, item);
+        bits[i] |= s;
+    }
+}
+
+#ifdef KNAPSACK_X86_DISPATCH
+
+/*
+ * 向量内核只处理按 B 个单元对齐、且整块都在 [max(lo, wt), hi] 内的块，
+ * 块内从高到低逐个向量处理；块外的零头交给标量代码。
+ */
+#define DP_VECTOR_BLOCKS(B, ...) \
+    int low = dp_row_prologue(prev, cur, keep, lo, hi, wt, sizeof(*cur)); \
+    int start, end, b; \
+    if (low > hi) return; \
+    start = (low + (B) - 1) / (B) * (B); \
+    end = (hi + 1) / (B) * (B); \
+    if (start >= end) { \
+        dp_row_range(prev, cur, keep, low, hi, wt, v); \
+        return; \
+    } \
+    if (end <= hi) dp_row_range(prev, cur, keep, end, hi, wt, v); \
+    for (b = end - (B); b >= start; b -= (B)) { __VA_ARGS__ } \
+    if (low < start) dp_row_range(prev, cur, keep, low, start - 1, wt, v);
+
+#define dp_row_range dp_row_f64_range
+
+__attribute__((target("sse2")))
+static void dp_row_f64_sse2(const double* prev, double* cur, unsigned char* keep, int lo, int hi, int wt, double v) {
+    __m128d vv = _mm_set1_pd(v);
+    DP_VECTOR_BLOCKS(8, {
+        int bits = 0, k;
+        for (k = 6; k >= 0; k -= 2) {
+            __m128d n = _mm_loadu_pd(prev + b + k);
+            __m128d t = _mm_add_pd(_mm_loadu_pd(prev + b + k - wt), vv);
+            __m128d m = _mm_cmpgt_pd(t, n);
+            _mm_storeu_pd(cur + b + k, _mm_or_pd(_mm_and_pd(m, t), _mm_andnot_pd(m, n)));
+            bits |= _mm_movemask_pd(m) << k;
+        }
+        if (keep) keep[b >> 3] = (unsigned char)bits;
+    })
+}
+
+__attribute__((target("avx2")))
+static void dp_row_f64_avx2(const double* prev, double* cur, unsigned char* keep, int lo, int hi, int wt, double v) {
+    __m256d vv = _mm256_set1_pd(v);
+    DP_VECTOR_BLOCKS(8, {
+        int bits = 0, k;
+        for (k = 4; k >= 0; k -= 4) {
+            __m256d n = _mm256_loadu_pd(prev + b + k);
+            __m256d t = _mm256_add_pd(_mm256_loadu_pd(prev + b + k - wt), vv);
+            __m256d m = _mm256_cmp_pd(t, n, _CMP_GT_OQ);
+            _mm256_storeu_pd(cur + b + k, _mm256_blendv_pd(n, t, m));
+            bits |= _mm256_movemask_pd(m) << k;
+        }
+        if (keep) keep[b >> 3] = (unsigned char)bits;
+    })
+}
+
+__attribute__((target("avx512f")))
+static void dp_row_f64_avx512(const double* prev, double* cur, unsigned char* keep, int lo, int hi, int wt, double v) {
+    __m512d vv = _mm512_set1_pd(v);
+    DP_VECTOR_BLOCKS(8, {
+        __m512d n = _mm512_loadu_pd(prev + b);
+        __m512d t = _mm512_add_pd(_mm512_loadu_pd(prev + b - wt), vv);
+        __mmask8 m = _mm512_cmp_pd_mask(t, n, _CMP_GT_OQ);
+        _mm512_storeu_pd(cur + b, _mm512_mask_blend_pd(m, n, t));
+        if (keep) keep[b >> 3] = (unsigned char)m;
+    })
+}
+
+#undef dp_row_range
+#define dp_row_range dp_row_i32_range
+
+__attribute__((target("sse2")))
+static void dp_row_i32_sse2(const int* prev, int* cur, unsigned char* keep, int lo, int hi, int wt, int v) {
+    __m128i vv = _mm_set1_epi32(v);
+    DP_VECTOR_BLOCKS(8, {
+        int bits = 0, k;
+        for (k = 4; k >= 0; k -= 4) {
+            __m128i n = _mm_loadu_si128((const __m128i*)(prev + b + k));
+            __m128i t = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(prev + b + k - wt)), vv);
+            __m128i m = _mm_cmpgt_epi32(t, n);
+            _mm_storeu_si128((__m128i*)(cur + b + k), _mm_or_si128(_mm_and_si128(m, t), _mm_andnot_si128(m, n)));
+            bits |= _mm_movemask_ps(_mm_castsi128_ps(m)) << k;
+        }
+        if (keep) keep[b >> 3] = (unsigned char)bits;
+    })
+}
+
+__attribute__((target("avx2")))
+static void dp_row_i32_avx2(const int* prev, int* cur, unsigned char* keep, int lo, int hi, int wt, int v) {
+    __m256i vv = _mm256_set1_epi32(v);
+    DP_VECTOR_BLOCKS(8, {
+        __m256i n = _mm256_loadu_si256((const __m256i*)(prev + b));
+        __m256i t = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(prev + b - wt)), vv);
+        __m256i m = _mm256_cmpgt_epi32(t, n);
+        _mm256_storeu_si256((__m256i*)(cur + b), _mm256_blendv_epi8(n, t, m));
+        if (keep) keep[b >> 3] = (unsigned char)_mm256_movemask_ps(_mm256_castsi256_ps(m));
+    })
+}
+
+__attribute__((target("avx512f")))
+static void dp_row_i32_avx512(const int* prev, int* cur, unsigned char* keep, int lo, int hi, int wt, int v) {
+    __m512i vv = _mm512_set1_epi32(v);
+    DP_VECTOR_BLOCKS(16, {
+        __m512i n = _mm512_loadu_si512((const void*)(prev + b));
+        __m512i t = _mm512_add_epi32(_mm512_loadu_si512((const void*)(prev + b - wt)), vv);
+        __mmask16 m = _mm512_cmpgt_epi32_mask(t, n);
+        _mm512_storeu_si512((void*)(cur + b), _mm512_mask_blend_epi32(m, n, t));
+        if (keep) {
+            keep[b >> 3] = (unsigned char)(m & 0xFF);
+            keep[(b >> 3) + 1] = (unsigned char)(m >> 8);
+        }
+    })
+}
+
+#undef dp_row_range
+#define dp_row_range dp_row_i64_range
+
+/* SSE2 没有64位整数比较指令，int64 只提供 AVX2 和 AVX-512 版本 */
+__attribute__((target("avx2")))
+static void dp_row_i64_avx2(const long long* prev, long long* cur, unsigned char* keep, int lo, int hi, int wt, long long v) {
+    __m256i vv = _mm256_set1_epi64x(v);
+    DP_VECTOR_BLOCKS(8, {
+        int bits = 0, k;
+        for (k = 4; k >= 0; k -= 4) {
+            __m256i n = _mm256_loadu_si256((const __m256i*)(prev + b + k));
+            __m256i t = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(prev + b + k - wt)), vv);
+            __m256i m = _mm256_cmpgt_epi64(t, n);
+            _mm256_storeu_si256((__m256i*)(cur + b + k), _mm256_blendv_epi8(n, t, m));
+            bits |= _mm256_movemask_pd(_mm256_castsi256_pd(m)) << k;
+        }
+        if (keep) keep[b >> 3] = (unsigned char)bits;
+    })
+}
+
+__attribute__((target("avx512f")))
+static void dp_row_i64_avx512(const long long* prev, long long* cur, unsigned char* keep, int lo, int hi, int wt, long long v) {
+    __m512i vv = _mm512_set1_epi64(v);
+    DP_VECTOR_BLOCKS(8, {
+        __m512i n = _mm512_loadu_si512((const void*)(prev + b));
+        __m512i t = _mm512_add_epi64(_mm512_loadu_si512((const void*)(prev + b - wt)), vv);
+        __mmask8 m = _mm512_cmpgt_epi64_mask(t, n);
+        _mm512_storeu_si512((void*)(cur + b), _mm512_mask_blend_epi64(m, n, t));
+        if (keep) keep[b >> 3] = (unsigned char)m;
+    })
+}
+
+#undef dp_row_range
+#undef DP_VECTOR_BLOCKS
+
+/* 位集内核用GCC向量扩展写一次，分别以 SSE2/AVX2/AVX-512 编译：每次处理 BYTES/8 个字，读取的低位字都在 0 以上的整块交给向量，其余交给标量 */
+#define BITSET_SHIFT_OR_KERNEL(name, isa, BYTES) \
+__attribute__((target(isa))) \
+static void name(unsigned long long* bits, int lo, int hi, int wt, int* first, int item) { \
+    typedef unsigned long long vw_t __attribute__((vector_size(BYTES))); \
+    const int lanes = (int)(BYTES / 8); \
+    int q = wt >> 6, r = wt & 63, start = lo > q + 1 ? lo : q + 1, i, k; \
+    for (i = hi - lanes + 1; i >= start; i -= lanes) { \
+        vw_t a, b, d, s; \
+        memcpy(&a, bits + i - q, BYTES); \
+        memcpy(&b, bits + i - q - 1, BYTES); \
+        memcpy(&d, bits + i, BYTES); \
+        s = r ? (a << r) | (b >> (64 - r)) : a; \
+        if (first) { \
+            vw_t fresh = s & ~d; \
+            for (k = 0; k < lanes; k++) { \
+                if (fresh[k]) bitset_record(fresh[k], (i + k) << 6, first, item); \
+            } \
+        } \
+        d |= s; \
+        memcpy(bits + i, &d, BYTES); \
+    } \
+    if (i + lanes - 1 >= lo) bitset_shift_or_scalar(bits, lo, i + lanes - 1, wt, first, item); \
+}
+
+BITSET_SHIFT_OR_KERNEL(bitset_shift_or_sse2, "sse2", 16)
+BITSET_SHIFT_OR_KERNEL(bitset_shift_or_avx2, "avx2", 32)
+BITSET_SHIFT_OR_KERNEL(bitset_shift_or_avx512, "avx512f", 64)
+#undef BITSET_SHIFT_OR_KERNEL
+
+#endif /* KNAPSACK_X86_DISPATCH */
+
+/* 当前选用的内核，dp_kernel_init() 之前为标量实现 */
+static dp_row_f64_fn dp_row_kernel_f64 = dp_row_f64_scalar;
+static dp_row_i32_fn dp_row_kernel_i32 = dp_row_i32_scalar;
+static dp_row_i64_fn dp_row_kernel_i64 = dp_row_i64_scalar;
+static bitset_shift_or_fn bitset_shift_or = bitset_shift_or_scalar;
+
+/* 类型泛型入口：按 cur 的元素类型选择 double / int / long long 内核 */
+#define dp_row_kernel(prev, cur, keep, lo, hi, wt, v) \
+    _Generic((cur), \
+        double*: dp_row_kernel_f64, \
+        int*: dp_row_kernel_i32, \
+        long long*: dp_row_kernel_i64)((prev), (cur), (keep), (lo), (hi), (wt), (v))
+
+/* 整行更新 [0, C] */
+#define dp_row_update(prev, cur, keep, C, wt, v) dp_row_kernel(prev, cur, keep, 0, C, wt, v)
+
+/* 根据CPU支持的指令集选择行更新内核（位集内核随之选择），返回内核名称 */
+static const char* dp_kernel_init(void) {
+#ifdef KNAPSACK_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        dp_row_kernel_f64 = dp_row_f64_avx512;
+        dp_row_kernel_i32 = dp_row_i32_avx512;
+        dp_row_kernel_i64 = dp_row_i64_avx512;
+        bitset_shift_or = bitset_shift_or_avx512;
+        return "AVX-512";
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        dp_row_kernel_f64 = dp_row_f64_avx2;
+        dp_row_kernel_i32 = dp_row_i32_avx2;
+        dp_row_kernel_i64 = dp_row_i64_avx2;
+        bitset_shift_or = bitset_shift_or_avx2;
+        return "AVX2";
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        dp_row_kernel_f64 = dp_row_f64_sse2;
+        dp_row_kernel_i32 = dp_row_i32_sse2;
+        dp_row_kernel_i64 = dp_row_i64_scalar;
+        bitset_shift_or = bitset_shift_or_sse2;
+        return "SSE2";
+    }
+#endif
+    dp_row_kernel_f64 = dp_row_f64_scalar;
+    dp_row_kernel_i32 = dp_row_i32_scalar;
+    dp_row_kernel_i64 = dp_row_i64_scalar;
+    bitset_shift_or = bitset_shift_or_scalar;
+    return "标量";
+}
+
+/*
+ * 按容量维度并行填表：每个物品的行只依赖上一行，因此把 [0, C] 切成若干段，
+ * 每个线程固定负责一段，处理完一个物品后在屏障处等待其他线程。
+ * 线程组在整个填表过程中保持不变（OpenMP 运行时会在多次并行区之间复用线程），
+ * 每段的首次写入也由负责该段的线程完成，使页面落在其所在的NUMA节点上。
+ */
+#define DP_SLICE_ALIGN 64        /* 段边界对齐，保证 keep 字节和缓存行不被两个线程共享 */
+#define DP_MIN_SLICE 8192        /* 每个线程至少负责的容量单元数，太小时屏障开销超过收益 */
+
+static int dp_threads = 1;
+
+/* 读取 KNAPSACK_THREADS 环境变量（默认使用全部核心），返回线程数 */
+static int dp_threads_init(void) {
+#ifdef _OPENMP
+    const char* env = getenv("KNAPSACK_THREADS");
+    dp_threads = (env && atoi(env) > 0) ? atoi(env) : omp_get_max_threads();
+#else
+    dp_threads = 1;
+#endif
+    return dp_threads;
+}
+
+/* 容量为 C 时实际使用的线程数 */
+static int dp_thread_count(int C) {
+    int t = (C + 1) / DP_MIN_SLICE;
+    if (t > dp_threads) t = dp_threads;
+    return t > 1 ? t : 1;
+}
+
+/* 当前线程负责的容量段 [*lo, *hi]，段为空时 *lo > *hi */
+static void dp_thread_slice(int C, int* lo, int* hi) {
+    int tid = 0, nt = 1;
+    int blocks = (C + DP_SLICE_ALIGN) / DP_SLICE_ALIGN;
+#ifdef _OPENMP
+    tid = omp_get_thread_num();
+    nt = omp_get_num_threads();
+#endif
+    *lo = (int)((long long)blocks * tid / nt) * DP_SLICE_ALIGN;
+    *hi = (int)((long long)blocks * (tid + 1) / nt) * DP_SLICE_ALIGN - 1;
+    if (*hi > C) *hi = C;
+}
+
+/*
+ * 分块填表：把连续 block 个物品、一段 width 个容量单元作为一块，块内逐物品调用行内核，
+ * 这 block+1 行的这一段留在 L2 中，前一行不必再从内存读一遍。
+ * 块 (b, t) 依赖同一组物品的前一段 (b, t-1)（读 w-wt 处）和前一组物品的同一段 (b-1, t)，
+ * 因此按反对角线 d = b + t 推进，同一条对角线上的块属于不同的行，可以并行。
+ * width 是 DP_SLICE_ALIGN 的倍数，同一行相邻两段不会共用 keep 字节。
+ * 只在两行放不进 L2 且能多线程时才分块（否则按容量分段逐行填表已经够快，分块只增加调度开销），
+ * 每块 DP_TILE_ITEMS 个物品；环境变量 KNAPSACK_TILE_ITEMS 可指定每块物品数并跳过 L2 判断，设为1则不分块。
+ */
+#define DP_TILE_ITEMS 16
+
+typedef void (*dp_tile_fn)(void* ctx, int item, int lo, int hi);
+
+/* L2 缓存大小（字节），取不到时按 1 MB */
+static size_t dp_l2_bytes(void) {
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) return (size_t)size;
+#endif
+    return (size_t)1 << 20;
+}
+
+/*
+ * 容量为 C、每个单元 elem 字节时的分块参数：返回每块物品数，*width 为每段容量单元数。
+ * 返回 1 表示不分块（只有一段、只有一个线程或两行放得进 L2），调用方按容量分段逐行填表。
+ */
+static int dp_tile_plan(int C, size_t elem, int* width) {
+    const char* env = getenv("KNAPSACK_TILE_ITEMS");
+    int block = (env && atoi(env) > 0) ? atoi(env) : DP_TILE_ITEMS;
+    size_t w = dp_l2_bytes() / 2 / ((size_t)(block + 1) * elem);   /* 只用一半 L2，留给 keep 和其他数据 */
+    w = w / DP_SLICE_ALIGN * DP_SLICE_ALIGN;
+    if (w < DP_SLICE_ALIGN) w = DP_SLICE_ALIGN;
+    if (w > (size_t)C + 1) w = ((size_t)C + DP_SLICE_ALIGN) / DP_SLICE_ALIGN * DP_SLICE_ALIGN;
+    *width = (int)w;
+    if (C / (int)w + 1 <= 1 || dp_thread_count(C) == 1) {
+        return 1;
+    }
+    if (!env && 2 * ((size_t)C + 1) * elem <= dp_l2_bytes()) {
+        return 1;
+    }
+    return block;
+}
+
+/* 按反对角线调度所有块，对每块内的每个物品 i（0 起）调用 fn(ctx, i, lo, hi) 计算第 i+1 行 */
+static void dp_tile_schedule(int n, int C, int block, int width, dp_tile_fn fn, void* ctx) {
+    int blocks = (n + block - 1) / block;
+    int tiles = C / width + 1;
+    #pragma omp parallel num_threads(dp_threads)
+    {
+        int d, b;
+        for (d = 0; d < blocks + tiles - 1; d++) {
+            int b_lo = d - tiles + 1 > 0 ? d - tiles + 1 : 0;
+            int b_hi = d < blocks - 1 ? d : blocks - 1;
+            #pragma omp for schedule(static)
+            for (b = b_lo; b <= b_hi; b++) {
+                int lo = (d - b) * width;
+                int hi = lo + width - 1 < C ? lo + width - 1 : C;
+                int i, last = (b + 1) * block < n ? (b + 1) * block : n;
+                for (i = b * block; i < last; i++) {
+                    fn(ctx, i, lo, hi);
+                }
+            }
+        }
+    }
+}
+
+/* 非负 double 的位模式按无符号整数比较时与数值同序；取反即为降序 */
+static unsigned long long order_key_double(double d) {
+    unsigned long long key;
+    memcpy(&key, &d, sizeof(key));
+    return key;
+}
+
+/*
+ * 按 key 升序的稳定 LSD 基数排序，idx 随 key 一起移动（下标排列，不搬动物品本身）。
+ * 8 趟的直方图在一次扫描中算完；所有键在某个字节上都相同时跳过该趟。
+ * key_tmp / idx_tmp 为同样长度的缓冲区，结果留在 key / idx 中。
+ */
+static void radix_sort_keys(unsigned long long* key, int* idx, int m, unsigned long long* key_tmp, int* idx_tmp) {
+    int count[8][256];
+    unsigned long long* src_k = key;
+    unsigned long long* dst_k = key_tmp;
+    int* src_i = idx;
+    int* dst_i = idx_tmp;
+    int pass, i;
+
+    if (m <= 1) {
+        return;
+    }
+    memset(count, 0, sizeof(count));
+    for (i = 0; i < m; i++) {
+        unsigned long long k = src_k[i];
+        for (pass = 0; pass < 8; pass++) {
+            count[pass][k >> (pass * 8) & 0xFF]++;
+        }
+    }
+    for (pass = 0; pass < 8; pass++) {
+        int shift = pass * 8, sum = 0;
+        int* pos = count[pass];
+        if (pos[src_k[0] >> shift & 0xFF] == m) {
+            continue;
+        }
+        for (i = 0; i < 256; i++) {
+            int c = pos[i];
+            pos[i] = sum;
+            sum += c;
+        }
+        for (i = 0; i < m; i++) {
+            int p = pos[src_k[i] >> shift & 0xFF]++;
+            dst_k[p] = src_k[i];
+            dst_i[p] = src_i[i];
+        }
+        {
+            unsigned long long* tk = src_k;
+            int* ti = src_i;
+            src_k = dst_k;
+            src_i = dst_i;
+            dst_k = tk;
+            dst_i = ti;
+        }
+    }
+    if (src_k != key) {
+        memcpy(key, src_k, (size_t)m * sizeof(unsigned long long));
+        memcpy(idx, src_i, (size_t)m * sizeof(int));
+    }
+}
+
+/*
+ * Philox4x32-10 计数器随机数发生器（Salmon 等, SC'11）：输出的 4 个 32 位数只由
+ * 128 位计数器和 64 位密钥决定，没有串行状态。以种子为密钥、物品下标为计数器，
+ * 任意一段物品都可以直接算出，多线程填充与单线程逐位相同，也不依赖C库的 rand()。
+ */
+typedef struct {
+    unsigned int v[4];
+} philox4x32_t;
+
+static philox4x32_t philox4x32(unsigned long long counter_lo, unsigned long long counter_hi, unsigned long long key) {
+    philox4x32_t r;
+    unsigned int c0 = (unsigned int)counter_lo, c1 = (unsigned int)(counter_lo >> 32);
+    unsigned int c2 = (unsigned int)counter_hi, c3 = (unsigned int)(counter_hi >> 32);
+    unsigned int k0 = (unsigned int)key, k1 = (unsigned int)(key >> 32);
+    int round;
+    for (round = 0; round < 10; round++) {
+        unsigned long long p0 = (unsigned long long)0xD2511F53u * c0;
+        unsigned long long p1 = (unsigned long long)0xCD9E8D57u * c2;
+        c0 = (unsigned int)(p1 >> 32) ^ c1 ^ k0;
+        c1 = (unsigned int)p1;
+        c2 = (unsigned int)(p0 >> 32) ^ c3 ^ k1;
+        c3 = (unsigned int)p0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    r.v[0] = c0;
+    r.v[1] = c1;
+    r.v[2] = c2;
+    r.v[3] = c3;
+    return r;
+}
+
+/* 把 32 位随机数映射到 [0, range)（乘法取高位，不用除法） */
+static unsigned int random_below(unsigned int x, unsigned int range) {
+    return (unsigned int)(((unsigned long long)x * range) >> 32);
+}
+
+#endif /* KNAPSACK_KERNEL_H */
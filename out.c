@@ -1,151 +1,198 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <math.h>
-#include <time.h>
-
-// 定义物品结构体
-typedef struct {
-    int weight;
-    int value;
-    double density; // 价值/重量比
-} Item;
-
-// 用于排序的比较函数
-int compareItems(const void *a, const void *b) {
-    Item *itemA = (Item *)a;
-    Item *itemB = (Item *)b;
-    if (itemA->density < itemB->density) return 1;
-    if (itemA->density > itemB->density) return -1;
-    return 0;
-}
-
-// 动态规划法 - O(n×C)
-double dynamicProgramming(Item *items, int n, int capacity) {
-    clock_t start = clock();
-    
-    // 创建二维DP表
-    int **dp = (int**)malloc((n + 1) * sizeof(int *));
-    for (int i = 0; i <= n; i++) {
-        dp[i] = (int *)calloc(capacity + 1, sizeof(int));
-    }
-    
-    // 填充DP表
-    for (int i = 1; i <= n; i++) {
-        for (int w = 1; w <= capacity; w++) {
-            if (items[i-1].weight <= w) {
-                dp[i][w] = fmax(dp[i-1][w], dp[i-1][w-items[i-1].weight] + items[i-1].value);
-            } else {
-                dp[i][w] = dp[i-1][w];
-            }
-        }
-    }
-    
-    int maxValue = dp[n][capacity];
-    
-    // 释放内存
-    for (int i = 0; i <= n; i++) {
-        free(dp[i]);
-    }
-    free(dp);
-    
-    clock_t end = clock();
-    double executionTime = ((double)(end - start) / CLOCKS_PER_SEC) * 1000; // 转换为毫秒
-    return executionTime;
-}
-
-// 贪心法 - O(n log n)
-double greedyAlgorithm(Item *items, int n, int capacity) {
-    clock_t start = clock();
-    
-    // 按密度排序
-    qsort(items, n, sizeof(Item), compareItems);
-    
-    int currentWeight = 0;
-    int maxValue = 0;
-    
-    // 贪心选择
-    for (int i = 0; i < n; i++) {
-        if (currentWeight + items[i].weight <= capacity) {
-            currentWeight += items[i].weight;
-            maxValue += items[i].value;
-        } else {
-            // 0-1背包问题不能部分装入，所以跳出循环
-            break;
-        }
-    }
-    
-    clock_t end = clock();
-    double executionTime = ((double)(end - start) / CLOCKS_PER_SEC) * 1000; // 转换为毫秒
-    return executionTime;
-}
-
-int main() {
-    int capacities[] = {100000}; // 背包容量
-    int numCapacities = sizeof(capacities) / sizeof(capacities[0]);
-    
-    // 修改后的物品数量列表，从1000递增到40000
-    int nValues[] = {1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 
-                     10000, 15000, 20000, 25000, 30000, 35000, 40000};
-    int numNValues = sizeof(nValues) / sizeof(nValues[0]);
-    
-    // 生成CSV文件名
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-    char filename[100];
-    sprintf(filename, "knapsack_results_N=%d_C=%d.csv", nValues[numNValues-1], capacities[0]);
-    
-    // 打开CSV文件
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        printf("无法创建CSV文件\n");
-        return 1;
-    }
-    
-    // 写入CSV表头
-    fprintf(file, "N=%d, C=%d\n", nValues[numNValues-1], capacities[0]);
-    fprintf(file, "算法,执行时间 (ms)\n");
-    
-    // 遍历不同的背包容量
-    for (int c = 0; c < numCapacities; c++) {
-        int capacity = capacities[c];
-        
-        // 遍历不同的物品数量
-        for (int i = 0; i < numNValues; i++) {
-            int n = nValues[i];
-            
-            // 分配物品数组内存
-            Item *items = (Item *)malloc(n * sizeof(Item));
-            if (items == NULL) {
-                printf("内存分配失败\n");
-                fclose(file);
-                return 1;
-            }
-            
-            // 生成随机物品数据
-            srand(time(NULL) + i);
-            for (int j = 0; j < n; j++) {
-                items[j].weight = rand() % 100 + 1; // 随机重量(1-100)
-                items[j].value = rand() % 100 + 1;  // 随机价值(1-100)
-                items[j].density = (double)items[j].value / items[j].weight;
-            }
-            
-            // 记录动态规划法执行时间
-            double dpTime = dynamicProgramming(items, n, capacity);
-            fprintf(file, "动态规划法,%.6f\n", dpTime);
-            
-            // 记录贪心法执行时间
-            double greedyTime = greedyAlgorithm(items, n, capacity);
-            fprintf(file, "贪心法,%.6f\n", greedyTime);
-            
-            // 释放内存
-            free(items);
-        }
-    }
-    
-    // 关闭文件
-    fclose(file);
-    printf("CSV文件已生成: %s\n", filename);
-    
-    return 0;
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "knapsack_kernel.h"
+
+// 物品按列存储：重量和价值都在1-100之间，各用一个字节
+typedef struct {
+    unsigned char *weight;
+    unsigned char *value;
+} Items;
+
+// 分块填表回调：计算DP表第 item+1 行的 [lo, hi] 段
+typedef struct {
+    Items *items;
+    int **dp;
+} DpTable;
+
+void fillTile(void *ctx, int item, int lo, int hi) {
+    DpTable *table = (DpTable *)ctx;
+    dp_row_kernel(table->dp[item], table->dp[item + 1], NULL, lo, hi,
+                  table->items->weight[item], table->items->value[item]);
+}
+
+// 墙钟时间（毫秒）：多线程填表时 clock() 统计的是所有线程的CPU时间之和，不能当执行时间
+double wallTimeMs(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// 动态规划法 - O(n×C)
+double dynamicProgramming(Items *items, int n, int capacity) {
+    double start = wallTimeMs();
+    
+    // 创建二维DP表
+    int **dp = (int**)malloc((n + 1) * sizeof(int *));
+    for (int i = 0; i <= n; i++) {
+        dp[i] = (int *)calloc(capacity + 1, sizeof(int));
+    }
+    
+    // 填充DP表：两行放不进L2且多线程时按"物品块 × 容量段"分块，否则逐物品按容量维度多线程
+    int tileWidth;
+    int tileItems = dp_tile_plan(capacity, sizeof(int), &tileWidth);
+    if (tileItems > 1) {
+        DpTable table = {items, dp};
+        dp_tile_schedule(n, capacity, tileItems, tileWidth, fillTile, &table);
+    } else {
+        #pragma omp parallel num_threads(dp_thread_count(capacity))
+        {
+            int lo, hi;
+            dp_thread_slice(capacity, &lo, &hi);
+            for (int i = 1; i <= n; i++) {
+                dp_row_kernel(dp[i-1], dp[i], NULL, lo, hi, items->weight[i-1], items->value[i-1]);
+                #pragma omp barrier
+            }
+        }
+    }
+    
+    int maxValue = dp[n][capacity];
+    
+    // 释放内存
+    for (int i = 0; i <= n; i++) {
+        free(dp[i]);
+    }
+    free(dp);
+    
+    return wallTimeMs() - start;
+}
+
+// 贪心法 - 按密度基数排序，O(n)
+double greedyAlgorithm(Items *items, int n, int capacity) {
+    double start = wallTimeMs();
+    
+    // 按密度降序排列下标：键为密度位模式取反，只移动键和下标
+    unsigned long long *key = (unsigned long long *)malloc(2 * n * sizeof(unsigned long long));
+    int *order = (int *)malloc(2 * n * sizeof(int));
+    if (key == NULL || order == NULL) {
+        free(key);
+        free(order);
+        return 0;
+    }
+    for (int i = 0; i < n; i++) {
+        key[i] = ~order_key_double((double)items->value[i] / items->weight[i]);
+        order[i] = i;
+    }
+    radix_sort_keys(key, order, n, key + n, order + n);
+    
+    int currentWeight = 0;
+    int maxValue = 0;
+    
+    // 贪心选择
+    for (int i = 0; i < n; i++) {
+        int k = order[i];
+        if (currentWeight + items->weight[k] <= capacity) {
+            currentWeight += items->weight[k];
+            maxValue += items->value[k];
+        } else {
+            // 0-1背包问题不能部分装入，所以跳出循环
+            break;
+        }
+    }
+    free(key);
+    free(order);
+    
+    return wallTimeMs() - start;
+}
+
+int main(int argc, char *argv[]) {
+    printf("DP行内核: %s\n", dp_kernel_init());
+    printf("DP填表线程数: %d\n", dp_threads_init());
+    
+    // 随机种子（默认1）：同一种子在任何机器上生成相同的实例
+    unsigned long long seed = argc > 1 ? strtoull(argv[1], NULL, 10) : 1;
+    printf("随机种子: %llu\n", seed);
+    
+    int capacities[] = {100000}; // 背包容量
+    int numCapacities = sizeof(capacities) / sizeof(capacities[0]);
+    int tileWidth;
+    int tileItems = dp_tile_plan(capacities[0], sizeof(int), &tileWidth);
+    if (tileItems > 1) {
+        printf("DP分块: 每块 %d 个物品 × %d 个容量单元，L2 %.0f KB\n", tileItems, tileWidth, dp_l2_bytes() / 1024.0);
+    } else {
+        printf("DP不分块: 按容量维度分段逐行填表，L2 %.0f KB\n", dp_l2_bytes() / 1024.0);
+    }
+    
+    // 修改后的物品数量列表，从1000递增到40000
+    int nValues[] = {1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 
+                     10000, 15000, 20000, 25000, 30000, 35000, 40000};
+    int numNValues = sizeof(nValues) / sizeof(nValues[0]);
+    
+    // 生成CSV文件名
+    time_t now = time(NULL);
+    struct tm *t = localtime(&now);
+    char filename[100];
+    sprintf(filename, "knapsack_results_N=%d_C=%d.csv", nValues[numNValues-1], capacities[0]);
+    
+    // 打开CSV文件
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        printf("无法创建CSV文件\n");
+        return 1;
+    }
+    
+    // 写入CSV表头
+    fprintf(file, "N=%d, C=%d\n", nValues[numNValues-1], capacities[0]);
+    fprintf(file, "算法,执行时间 (ms)\n");
+    
+    // 遍历不同的背包容量
+    for (int c = 0; c < numCapacities; c++) {
+        int capacity = capacities[c];
+        
+        // 遍历不同的物品数量
+        for (int i = 0; i < numNValues; i++) {
+            int n = nValues[i];
+            
+            // 分配物品数组内存
+            Items items;
+            items.weight = (unsigned char *)malloc(n);
+            items.value = (unsigned char *)malloc(n);
+            if (items.weight == NULL || items.value == NULL) {
+                printf("内存分配失败\n");
+                free(items.weight);
+                free(items.value);
+                fclose(file);
+                return 1;
+            }
+            
+            // 生成随机物品数据：第 i 组的物品 j 由 (种子, i, j) 决定，可并行生成
+            #pragma omp parallel for schedule(static) num_threads(dp_threads)
+            for (int j = 0; j < n; j++) {
+                philox4x32_t r = philox4x32(j, i, seed);
+                items.weight[j] = random_below(r.v[0], 100) + 1; // 随机重量(1-100)
+                items.value[j] = random_below(r.v[1], 100) + 1;  // 随机价值(1-100)
+            }
+            
+            // 记录动态规划法执行时间
+            double dpTime = dynamicProgramming(&items, n, capacity);
+            fprintf(file, "动态规划法,%.6f\n", dpTime);
+            
+            // 记录贪心法执行时间
+            double greedyTime = greedyAlgorithm(&items, n, capacity);
+            fprintf(file, "贪心法,%.6f\n", greedyTime);
+            
+            // 释放内存
+            free(items.weight);
+            free(items.value);
+        }
+    }
+    
+    // 关闭文件
+    fclose(file);
+    printf("CSV文件已生成: %s\n", filename);
+    
+    return 0;
 }    
\ No newline at end of file